@@ -8,6 +8,8 @@
  * Key Responsibilities:
  * - Global status variable initialization and management
  * - Token list management (adding, counting, storing tokens)
+ * - Symbol table: lexemes interned once, compared by ID (same_lexeme)
+ * - Lexeme store: copies of the token lexemes that the tokens point to
  * - Token buffer operations (creation, clearing, character addition)
  * - Category to string conversion for output formatting
  * - Token output to file and token list storage
@@ -53,7 +55,125 @@ Category string_to_category(const char* str) {
     return CAT_INDIFERENT;
 }
 
-void add_token_to_list(char* lexeme, Category cat) {
+// FNV-1a of the lexeme
+static uint32_t symbol_hash(const char* lexeme) {
+    uint32_t h = 2166136261u;
+    for (const char* c = lexeme; *c; c++) {
+        h = (h ^ (unsigned char)*c) * 16777619u;
+    }
+    return h;
+}
+
+/**
+ * ID of the lexeme in status.symbols: the one it already has, or a new one (the lexeme is copied)
+ * Returns NO_SYMBOL if the table is full, then same_lexeme compares the strings
+ */
+int intern_symbol(const char* lexeme) {
+    SymbolTable* table = &status.symbols;
+    int s = (int)(symbol_hash(lexeme) & (SYMBOL_SLOTS - 1));
+    while (table->slots[s] != NO_SYMBOL) { // Sondeig lineal
+        if (strcmp(table->names[table->slots[s]], lexeme) == 0) {
+            return table->slots[s];
+        }
+        s = (s + 1) & (SYMBOL_SLOTS - 1);
+    }
+    if (table->count >= MAX_SYMBOLS) {
+        return NO_SYMBOL;
+    }
+    char* name = malloc(strlen(lexeme) + 1);
+    if (!name) {
+        return NO_SYMBOL;
+    }
+    strcpy(name, lexeme);
+    int id = ++table->count;
+    table->names[id] = name;
+    table->slots[s] = id;
+    return id;
+}
+
+// Same lexeme: one compare when both are interned
+bool same_lexeme(const Token* a, const Token* b) {
+    if (a->symbol != NO_SYMBOL && b->symbol != NO_SYMBOL) {
+        return a->symbol == b->symbol;
+    }
+    return a->len == b->len && memcmp(a->lexeme, b->lexeme, a->len) == 0;
+}
+
+void free_symbols(void) {
+    for (int id = 1; id <= status.symbols.count; id++) {
+        free(status.symbols.names[id]);
+    }
+    memset(&status.symbols, 0, sizeof(status.symbols));
+}
+
+/**
+ * Points the token to lexeme interned (status.symbols keeps the copy), or to a copy in the
+ * lexeme store if the table is full. For the grammar symbols and the tokens made by the parser
+ */
+void set_token_lexeme(Token* token, const char* lexeme) {
+    int len = (int)strlen(lexeme);
+    token->symbol = intern_symbol(lexeme);
+    token->lexeme = token->symbol != NO_SYMBOL ? status.symbols.names[token->symbol] : store_lexeme(lexeme, len);
+    token->len = len;
+    if (!token->lexeme) { // Sense memòria: buit
+        token->lexeme = "";
+        token->len = 0;
+    }
+}
+
+/**
+ * Copy of lexeme[0 .. len) and a '\0' in the lexeme store (status.lexemes); it does not move
+ * until free_lexemes. Returns NULL if out of memory
+ */
+const char* store_lexeme(const char* lexeme, int len) {
+    size_t need = (size_t)len + 1;
+    LexemeBlock* block = status.lexemes;
+    if (!block || block->size - block->used < need) {
+        size_t size = need > LEXEME_BLOCK ? need : LEXEME_BLOCK;
+        LexemeBlock* fresh = malloc(sizeof(LexemeBlock) + size);
+        if (!fresh) {
+            return NULL;
+        }
+        fresh->used = 0;
+        fresh->size = size;
+        if (block && size > LEXEME_BLOCK) { // Un lexema llarg té el seu bloc: el de davant es continua omplint
+            fresh->next = block->next;
+            block->next = fresh;
+        } else {
+            fresh->next = block;
+            status.lexemes = fresh;
+        }
+        block = fresh;
+    }
+    char* copy = block->text + block->used;
+    memcpy(copy, lexeme, (size_t)len);
+    copy[len] = '\0';
+    block->used += need;
+    return copy;
+}
+
+void free_lexemes(void) {
+    while (status.lexemes) {
+        LexemeBlock* next = status.lexemes->next;
+        free(status.lexemes);
+        status.lexemes = next;
+    }
+}
+
+// Adds a token whose lexeme is only valid during the call (e.g. a field of the .cscn): it is copied to the lexeme store
+void add_token_to_list(const char* lexeme, Category cat) {
+    int len = (int)strlen(lexeme);
+    const char* copy = store_lexeme(lexeme, len);
+    if (!copy) {
+        fprintf(stderr, "WARNING: Out of memory for the lexemes, token discarded\n");
+        return;
+    }
+    add_symbol_token_to_list(copy, len, cat, intern_symbol(copy));
+}
+
+// Adds a token with the ID of its lexeme already known (e.g. from a .cscnb)
+// The lexeme (len bytes and a '\0') is not copied: it has to stay valid while parsing
+void add_symbol_token_to_list(const char* lexeme, int len, Category cat, int symbol) {
     if (status.all_tokens.count >= MAX_TOKENS) {
         fprintf(stderr, "WARNING: Maximum token count reached, token discarded\n");
         return;
@@ -61,11 +181,11 @@ void add_token_to_list(char* lexeme, Category cat) {
 
     Token *t = &status.all_tokens.tokens[status.all_tokens.count];
 
-    strncpy(t->lexeme, lexeme, MAX_TOKEN_NAME - 1);
-    t->lexeme[MAX_TOKEN_NAME - 1] = '\0'; // ensure termination
- 
+    t->lexeme = lexeme;
+    t->len = len;
     t->cat = cat;
     t->line = status.line; //will always be 0, we don't use it I think
+    t->symbol = symbol;
 
     status.all_tokens.count++;
 }
@@ -162,7 +282,7 @@ void initialize_stack(Stack *stack, AutomataDFA dfa) {
     stack->top = -1;
     RuleItem bottom = {0};  // Zero-initialize to avoid garbage
     bottom.type = TERMINAL_SYMBOL;
-    strcpy(bottom.token.lexeme, EPSILON);
+    set_token_lexeme(&bottom.token, EPSILON);
     push_stack(stack, bottom, dfa.start_state);
 }
 
@@ -231,7 +351,7 @@ void split_path(const char *fullpath, char *path, char *filename, char *extensio
 
     if (last_dot && last_dot > last_slash) {
         strcpy(extension, last_dot + 1);
-        filename[last_dot - last_slash - 1] = '\0';  // remove extension from filename
+        filename[last_dot - (last_slash ? last_slash + 1 : fullpath)] = '\0';  // remove extension from filename (no '/': from the start)
     } else {
         extension[0] = '\0';
     }
@@ -324,7 +444,7 @@ void stack_to_string(const Stack *stack, char *output, size_t output_size) {
 
     // Read from bottom (0) to top
     for (int i = 0; i <= stack->top; i++) {
-        const char *lexeme = stack->elements[i].symbol.token.lexeme;
+        const Token *token = &stack->elements[i].symbol.token;
         
         // Add space if not the first element
         if (i > 0 && current_len < output_size - 1) {
@@ -333,9 +453,9 @@ void stack_to_string(const Stack *stack, char *output, size_t output_size) {
         }
         
         // Append lexeme to output
-        int lexeme_len = strlen(lexeme);
+        size_t lexeme_len = (size_t)token->len;
         if (current_len + lexeme_len < output_size - 1) {
-            strncpy(&output[current_len], lexeme, output_size - current_len - 1);
+            memcpy(&output[current_len], token->lexeme, lexeme_len);
             current_len += lexeme_len;
             output[current_len] = '\0';
         } else {
@@ -490,8 +610,7 @@ int load_language(const char* filename, LanguageV2* lang) {
                 lang->nonterminals[idx][0].token.cat       = CAT_INDIFERENT;
                 lang->nonterminals[idx][0].token.line      = 0;
                 lang->nonterminals[idx][0].column          = col;
-                strncpy(lang->nonterminals[idx][0].token.lexeme, sym, MAX_TOKEN_NAME - 1);
-                lang->nonterminals[idx][0].token.lexeme[MAX_TOKEN_NAME - 1] = '\0';
+                set_token_lexeme(&lang->nonterminals[idx][0].token, sym);
                 lang->num_nonterminals++;
 
                 // advance past closing ')' of this tuple
@@ -554,18 +673,16 @@ int load_language(const char* filename, LanguageV2* lang) {
                 if (detected != CAT_INDIFERENT) {
                     // e.g. (CAT_NUMBER, 5)  -->  (TERMINAL, ("CAT_NUMBER", CAT_NUMBER, 0), 5)
                     lang->terminals[idx].token.cat = detected;
-                    strncpy(lang->terminals[idx].token.lexeme, sym, MAX_TOKEN_NAME - 1);
-                    lang->terminals[idx].token.lexeme[MAX_TOKEN_NAME - 1] = '\0';
+                    set_token_lexeme(&lang->terminals[idx].token, sym);
                 } else {
                     // Regular terminal symbol, CAT_INDIFERENT, match by lexeme
                     lang->terminals[idx].token.cat = CAT_INDIFERENT;
                     // Replace bare '$' with EOF_TOKEN_LEXEME string
                     if (strcmp(sym, "$") == 0) {
-                        strncpy(lang->terminals[idx].token.lexeme, "$end", MAX_TOKEN_NAME - 1);
+                        set_token_lexeme(&lang->terminals[idx].token, "$end");
                     } else {
-                        strncpy(lang->terminals[idx].token.lexeme, sym, MAX_TOKEN_NAME - 1);
+                        set_token_lexeme(&lang->terminals[idx].token, sym);
                     }
-                    lang->terminals[idx].token.lexeme[MAX_TOKEN_NAME - 1] = '\0';
                 }
 
                 lang->num_terminals++;
@@ -696,8 +813,7 @@ int load_language(const char* filename, LanguageV2* lang) {
                 lang->productions[production_idx].lhs[0].token.cat       = CAT_INDIFERENT;
                 lang->productions[production_idx].lhs[0].token.line      = 0;
                 lang->productions[production_idx].lhs[0].column          = -1;
-                strncpy(lang->productions[production_idx].lhs[0].token.lexeme, lhs_start, MAX_TOKEN_NAME - 1);
-                lang->productions[production_idx].lhs[0].token.lexeme[MAX_TOKEN_NAME - 1] = '\0';
+                set_token_lexeme(&lang->productions[production_idx].lhs[0].token, lhs_start);
             }
             lang->productions[production_idx].lhs_length = 1;
 
@@ -726,8 +842,7 @@ int load_language(const char* filename, LanguageV2* lang) {
                     lang->productions[production_idx].rhs[rhs_idx].token.cat       = CAT_INDIFERENT;
                     lang->productions[production_idx].rhs[rhs_idx].token.line      = 0;
                     lang->productions[production_idx].rhs[rhs_idx].column          = -1;
-                    strncpy(lang->productions[production_idx].rhs[rhs_idx].token.lexeme, sym_tok, MAX_TOKEN_NAME - 1);
-                    lang->productions[production_idx].rhs[rhs_idx].token.lexeme[MAX_TOKEN_NAME - 1] = '\0';
+                    set_token_lexeme(&lang->productions[production_idx].rhs[rhs_idx].token, sym_tok);
                 }
                 rhs_idx++;
                 sym_tok = strtok(NULL, " \t");
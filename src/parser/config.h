@@ -23,6 +23,7 @@
  
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>     // To set env for time zone
 #include <string.h>     // For filename manipulation    
 #include <time.h>       // For time-stamp of output logs filenames
@@ -74,6 +75,8 @@
 #define MAX_SYMBOL_LEN 64
 #define MAX_INPUT_LENGTH 1024
 #define MAX_OPERATION_NAME 256
+#define MAX_SYMBOLS 2048        // Different lexemes of the tokens and the grammar (symbol table)
+#define SYMBOL_SLOTS 4096       // Slots of the symbol hash table (power of two, at most half full)
 
 // -----------------RETURN VALUES------------------------------------------------ 
 #define ERROR_RETURN -1
@@ -139,11 +142,61 @@ typedef enum {
 // ------------------Token and token list------------------------------------------------- 
 
 typedef struct Token {
-    char lexeme[MAX_TOKEN_NAME];    //Literal string (lexeme)    
+    const char* lexeme;             //Literal string (lexeme): len bytes and a '\0', not owned by the token:
+                                    //the .cscnb mapping, the lexeme store or the symbol table (see below)
+    int len;
     Category cat;                   //Category from the ones above
     int line;                       //Line number where the token starts
+    int symbol;                     //ID of the lexeme in status.symbols (NO_SYMBOL: compare the lexeme)
 } Token;
 
+//Symbol table: every different lexeme is stored once with an ID, so tokens and grammar
+//symbols compare IDs instead of strings (same_lexeme)
+#define NO_SYMBOL 0                 //IDs start at 1, a zero-initialized Token has no symbol
+
+typedef struct SymbolTable {
+    char* names[MAX_SYMBOLS + 1];   //names[id] = lexeme of the symbol (names[0] unused)
+    int count;
+    int slots[SYMBOL_SLOTS];        //Symbol ID of each slot, NO_SYMBOL = empty (open addressing)
+} SymbolTable;
+
+//Binary token file written by the scanner with -binary (same structs in src/scanner/config.h)
+//Layout: CscnHeader | string table (lexemes, each ended in '\0') | CscnRecord[num_tokens]
+//The string table starts with the num_symbols interned lexemes, each one once (in ID order)
+#define CSCN_MAGIC "CSCN"
+#define CSCN_VERSION 2
+#define CSCN_NO_SYMBOL 0xFFFFFFFFu
+
+typedef struct CscnHeader {
+    char magic[4];              // CSCN_MAGIC (no '\0')
+    uint32_t version;
+    uint32_t num_tokens;
+    uint32_t strings_offset;    // From the start of the file
+    uint32_t strings_size;
+    uint32_t records_offset;    // Multiple of 4, so records can be read in place
+    uint32_t num_symbols;       // Interned lexemes (symbol IDs 0 .. num_symbols - 1)
+} CscnHeader;
+
+typedef struct CscnRecord {
+    uint8_t cat;                // Category
+    uint8_t reserved[3];
+    uint32_t line;
+    uint32_t lexeme;            // Offset of the lexeme in the string table
+    uint32_t len;               // Length of the lexeme (without the '\0')
+    uint32_t symbol;            // Scanner symbol ID (same lexeme = same ID), CSCN_NO_SYMBOL if not interned
+} CscnRecord;
+
+//Copies of the lexemes of the tokens read from a .cscn or scanned from a .c (store_lexeme):
+//blocks that are never moved, so the tokens can point to them until free_lexemes
+#define LEXEME_BLOCK 65536          //Bytes of a block (a longer lexeme gets a block of its own)
+
+typedef struct LexemeBlock {
+    struct LexemeBlock* next;
+    size_t used;
+    size_t size;
+    char text[];
+} LexemeBlock;
+
 typedef struct ListTokens {
     Token tokens[MAX_TOKENS];
     int count;
@@ -296,6 +349,8 @@ typedef struct {
     FILE* error_file;
 
     ListTokens all_tokens;
+    SymbolTable symbols;    //Lexemes of all_tokens and of the grammar, interned
+    LexemeBlock* lexemes;   //Lexeme store of all_tokens (not used for a .cscnb: they point to its mapping)
 
 	int line;           //In which line are we
 
@@ -332,11 +387,27 @@ extern Status status;
 //----------------------- Function prototypes------------------------------------------
 FILE* set_output_test_file(const char* filename);
 
+void split_path(const char *fullpath, char *path, char *filename, char *extension);
+
 const char* category_to_string(Category cat);
 
 Category string_to_category(const char* str);
 
-void add_token_to_list(char* lexeme, Category cat);
+void add_token_to_list(const char* lexeme, Category cat);
+
+void add_symbol_token_to_list(const char* lexeme, int len, Category cat, int symbol);
+
+int intern_symbol(const char* lexeme);
+
+void set_token_lexeme(Token* token, const char* lexeme);
+
+const char* store_lexeme(const char* lexeme, int len);
+
+void free_lexemes(void);
+
+bool same_lexeme(const Token* a, const Token* b);
+
+void free_symbols(void);
 
 void buffer_clear(BufferAuto *buffer);
 
@@ -13,6 +13,16 @@
  *     <if, CAT_KEYWORD> <(, CAT_SPECIALCHAR> <x, CAT_IDENTIFIER>
  *     <3, CAT_NUMBER> <+, CAT_OPERATOR>
  *
+ * .cscnb format (scanner run with -binary):
+ *   CscnHeader | string table | CscnRecord[num_tokens]  (see config.h)
+ *   The file is mapped with mmap and the records are read in place, no
+ *   text parsing. The text .cscn is still the default (easier to debug).
+ *   Every interned lexeme of the scanner (symbol ID) is interned here only
+ *   the first time it appears, the other tokens with that ID reuse it.
+ *
+ * .c source files are scanned in memory with the scanner's module_api
+ * (scan_source.c) and their tokens are added as the .cscnb ones.
+ *
  * Generic operations (add_token_to_list, category_to_string, etc.) are in
  * config.c and are reused here directly.
  *
@@ -24,35 +34,53 @@
 #include "../main.h"
 #include "../config.h"
 #include "module_load_tokens.h"
+#include "scan_source.h"
+#include <limits.h>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
 
 /* -------------------------------------------------------------------------
- * Reads characters from f into buf (max len-1 chars) until 'stop' is found.
+ * Reads characters from f into *buf until 'stop' is found. The buffer
+ * (*size bytes, malloc'ed) grows to fit the whole field, so a long lexeme
+ * is not cut. Returns the length, -1 at the end of the file or out of memory.
  * ------------------------------------------------------------------------- */
-static int read_field(FILE* f, char* buf, int len, char stop) {
+static int read_field(FILE* f, char** buf, int* size, char stop) {
     int i = 0;
     int c;
 
     while ((c = fgetc(f)) != EOF) {
         if ((char)c == stop) break;
-        if (i < len - 1) buf[i++] = (char)c;
+        if (i + 1 >= *size) {
+            char* grown = realloc(*buf, (size_t)*size * 2);
+            if (!grown) return -1;
+            *buf = grown;
+            *size *= 2;
+        }
+        (*buf)[i++] = (char)c;
     }
-    buf[i] = '\0';
+    (*buf)[i] = '\0';
 
     if (c == EOF && i == 0) return -1;
 
     // Trim trailing spaces
-    while (i > 0 && buf[i - 1] == ' ') buf[--i] = '\0';
+    while (i > 0 && (*buf)[i - 1] == ' ') (*buf)[--i] = '\0';
 
     // Trim leading spaces
     int start = 0;
-    while (buf[start] == ' ') start++;
-    if (start > 0) memmove(buf, buf + start, i - start + 1);
+    while ((*buf)[start] == ' ') start++;
+    if (start > 0) memmove(*buf, *buf + start, i - start + 1);
 
     return i - start;
 }
 
 /* -------------------------------------------------------------------------
  * Opens the .cscn file, parses every <lexeme, CATEGORY> entry and adds each token to status.all_tokens via add_token_to_list() from config.c.
+ * The lexemes are copied to the lexeme store (store_lexeme), whole.
  * ------------------------------------------------------------------------- */
 int load_tokens_from_file(const char* filename) {
     FILE* f = fopen(filename, "r");
@@ -62,65 +90,255 @@ int load_tokens_from_file(const char* filename) {
     }
     // Reset token list before loading
     status.all_tokens.count = 0;
-    char lexeme[MAX_TOKEN_NAME];
-    char cat_str[MAX_TOKEN_NAME];
+    int lexeme_size = MAX_TOKEN_NAME;
+    int cat_size = MAX_TOKEN_NAME;
+    char* lexeme = malloc((size_t)lexeme_size);
+    char* cat_str = malloc((size_t)cat_size);
+    if (!lexeme || !cat_str) {
+        fprintf(stderr, "Error: out of memory loading %s\n", filename);
+        free(lexeme);
+        free(cat_str);
+        fclose(f);
+        return ERROR_RETURN;
+    }
 
     int c;
     while ((c = fgetc(f)) != EOF) {
         if ((char)c != '<') continue;   // advance until next token 
         // Read lexeme
-        if (read_field(f, lexeme, MAX_TOKEN_NAME, ',') < 0) break; //Potser podriem fer un define que es digui "INICI_TOKEN, SEPARADOR_TOKEN, FINAL_TOKEN" per "<"" "," i ">" ?
+        if (read_field(f, &lexeme, &lexeme_size, ',') < 0) break; //Potser podriem fer un define que es digui "INICI_TOKEN, SEPARADOR_TOKEN, FINAL_TOKEN" per "<"" "," i ">" ?
         // Read category
-        if (read_field(f, cat_str, MAX_TOKEN_NAME, '>') < 0) break;
+        if (read_field(f, &cat_str, &cat_size, '>') < 0) break;
         Category cat = string_to_category(cat_str);
         add_token_to_list(lexeme, cat);  // defined in config.c (de l'altra pràctica)
     }
 
+    free(lexeme);
+    free(cat_str);
     fclose(f);
     return CORRECT_RETURN;
 }
 
 /* -------------------------------------------------------------------------
- * temporal sets up the scanner's required state (ifile, line counters, ofile) to run automata_driver() over the .c file
- * will write the scanner's output to /dev/null to avoid polluting the parser's output file, but the important side-effect is that add_token_to_list() fills status.all_tokens.
+ * .cscnb loaded by load_tokens_from_binary: the tokens point to the lexemes
+ * of its string table, so it stays mapped (or read) until unload_tokens.
  * ------------------------------------------------------------------------- */
-static int load_tokens_from_scan(void) {
-    // Open the .c source file for the scanner to read
-    // status.ifile = fopen(status.ifile_name, "r");
-    // if (!status.ifile) {
-    //     fprintf(stderr, "File not found: %s\n", status.ifile_name);
-    //     return ERROR_RETURN;
-    // }
-
-    // FILE* scanner_out = fopen("/dev/null", "w");
-    // if (!scanner_out) scanner_out = status.ofile; 
-
-    // FILE* saved_ofile = status.ofile;
-    // status.ofile = scanner_out;
-
-    // // Reset scanner-specific status fields
-    // status.line = 1;
-    // status.first_token_in_line = true;
-    // status.line_has_tokens = false;
-    // status.all_tokens.count = 0;
-
-    // // Run the scanner
-    // AutomataList automata_list;
-    // init_automata(&automata_list);
-    // automata_driver(automata_list.automatas, automata_list.num_automata);
-
-    // // Restore parser state
-    // fclose(status.ifile);
-    // status.ifile = NULL;
-    // if (scanner_out != saved_ofile) fclose(scanner_out);
-    // status.ofile = saved_ofile;
-    // return CORRECT_RETURN;
+static char* token_image = NULL;
+static size_t token_image_size = 0;
+
+static void release_token_image(void) {
+    if (!token_image) return;
+#ifdef _WIN32
+    free(token_image);
+#else
+    munmap(token_image, token_image_size);
+#endif
+    token_image = NULL;
+    token_image_size = 0;
+}
+
+/* -------------------------------------------------------------------------
+ * Adds the tokens of a mapped (or read) .cscnb image to status.all_tokens.
+ * Their lexemes point to the string table of the image (any length, no copy),
+ * so the image has to be kept until the parse ends (unload_tokens).
+ * Categories the parser does not use (CAT_NONRECOGNIZED) become
+ * CAT_INDIFERENT, as string_to_category() does for the text format.
+ * ------------------------------------------------------------------------- */
+static int load_tokens_from_image(const char* data, size_t size, const char* filename) {
+    const CscnHeader* header = (const CscnHeader*)data;
+    if (size < sizeof(CscnHeader) || memcmp(header->magic, CSCN_MAGIC, 4) != 0
+            || header->version != CSCN_VERSION
+            || (size_t)header->strings_offset + header->strings_size > size
+            || header->records_offset % 4 != 0
+            || header->records_offset < sizeof(CscnHeader) || header->records_offset > size   // Abans de restar
+            || (size - header->records_offset) / sizeof(CscnRecord) < header->num_tokens) {
+        fprintf(stderr, "Error: %s is not a valid binary token file\n", filename);
+        return ERROR_RETURN;
+    }
+
+    const char* strings = data + header->strings_offset;
+    const CscnRecord* records = (const CscnRecord*)(data + header->records_offset);
+
+    // symbol_of[scanner ID] = ID in status.symbols (NO_SYMBOL = not seen yet)
+    int* symbol_of = calloc((size_t)header->num_symbols + 1, sizeof(int));
+    if (!symbol_of) {
+        fprintf(stderr, "Error: out of memory loading %s\n", filename);
+        return ERROR_RETURN;
+    }
+
+    status.all_tokens.count = 0;
+    for (uint32_t i = 0; i < header->num_tokens; i++) {
+        const CscnRecord* r = &records[i];
+        if ((size_t)r->lexeme + r->len >= header->strings_size || r->len > INT_MAX
+                || strings[r->lexeme + r->len] != '\0'   // The token points to it: it has to end there
+                || (r->symbol != CSCN_NO_SYMBOL && r->symbol >= header->num_symbols)) {
+            fprintf(stderr, "Error: %s has a lexeme out of the string table\n", filename);
+            free(symbol_of);
+            status.all_tokens.count = 0;    // They point to the image, that is not kept
+            return ERROR_RETURN;
+        }
+        const char* lexeme = strings + r->lexeme;   // Not copied: the image stays mapped while parsing
+
+        Category cat = r->cat <= CAT_SPECIALCHAR ? (Category)r->cat : CAT_INDIFERENT;
+        int symbol;
+        if (r->symbol == CSCN_NO_SYMBOL) {
+            symbol = intern_symbol(lexeme);
+        } else {
+            if (symbol_of[r->symbol] == NO_SYMBOL) { // Primer cop que surt aquest símbol
+                symbol_of[r->symbol] = intern_symbol(lexeme);
+            }
+            symbol = symbol_of[r->symbol];
+        }
+        int before = status.all_tokens.count;
+        add_symbol_token_to_list(lexeme, (int)r->len, cat, symbol);
+        if (status.all_tokens.count > before) {
+            status.all_tokens.tokens[before].line = (int)r->line;  // The binary file keeps the line
+        }
+    }
+    free(symbol_of);
+    return CORRECT_RETURN;
+}
+
+/* -------------------------------------------------------------------------
+ * Maps the .cscnb file (mmap) and loads its tokens. Windows has no mmap,
+ * so there the file is read into memory instead. Either way it is kept
+ * until unload_tokens.
+ * ------------------------------------------------------------------------- */
+int load_tokens_from_binary(const char* filename) {
+#ifdef _WIN32
+    FILE* f = fopen(filename, "rb");
+    if (!f) {
+        fprintf(stderr, "File not found: %s\n", filename);
+        return ERROR_RETURN;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* data = malloc(size > 0 ? (size_t)size : 1);
+    if (!data || fread(data, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "Error: could not read %s\n", filename);
+        free(data);
+        fclose(f);
+        return ERROR_RETURN;
+    }
+    fclose(f);
+    int result = load_tokens_from_image(data, (size_t)size, filename);
+    if (result != CORRECT_RETURN) {
+        free(data);
+        return result;
+    }
+    release_token_image();
+    token_image = data;         // Freed by unload_tokens
+    token_image_size = (size_t)size;
+    return result;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "File not found: %s\n", filename);
+        return ERROR_RETURN;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(CscnHeader)) {
+        fprintf(stderr, "Error: %s is not a valid binary token file\n", filename);
+        close(fd);
+        return ERROR_RETURN;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping stays valid after closing the descriptor
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Error: could not map %s\n", filename);
+        return ERROR_RETURN;
+    }
+    int result = load_tokens_from_image((const char*)data, (size_t)st.st_size, filename);
+    if (result != CORRECT_RETURN) {
+        munmap(data, (size_t)st.st_size);
+        return result;
+    }
+    release_token_image();
+    token_image = data;         // Unmapped by unload_tokens: the tokens point to its lexemes
+    token_image_size = (size_t)st.st_size;
+    return result;
+#endif
+}
+
+/* -------------------------------------------------------------------------
+ * Symbols of the scanned tokens: symbol_of[scanner ID] = ID in status.symbols
+ * (NO_SYMBOL = not seen yet), grown as new scanner IDs appear.
+ * ------------------------------------------------------------------------- */
+typedef struct SourceLoad {
+    int* symbol_of;
+    int capacity;
+    bool out_of_memory;
+} SourceLoad;
+
+static void add_source_token(const SourceToken* token, void* context) {
+    SourceLoad* load = (SourceLoad*)context;
+    const char* lexeme = store_lexeme(token->lexeme, token->len); // The scanner is closed after the scan
+    if (!lexeme) {
+        load->out_of_memory = true;
+        return;
+    }
+
+    Category cat = token->cat >= 0 && token->cat <= CAT_SPECIALCHAR ? (Category)token->cat : CAT_INDIFERENT;
+    int symbol;
+    if (token->symbol < 0) {   // Com a load_tokens_from_image: també s'internen els altres lexemes
+        symbol = intern_symbol(lexeme);
+    } else {
+        if (token->symbol >= load->capacity) {
+            int capacity = load->capacity ? load->capacity * 2 : 256;
+            while (capacity <= token->symbol) capacity *= 2;
+            int* grown = realloc(load->symbol_of, capacity * sizeof(int));
+            if (!grown) {
+                load->out_of_memory = true;
+                return;
+            }
+            memset(grown + load->capacity, 0, (capacity - load->capacity) * sizeof(int)); // NO_SYMBOL
+            load->symbol_of = grown;
+            load->capacity = capacity;
+        }
+        if (load->symbol_of[token->symbol] == NO_SYMBOL) { // Primer cop que surt aquest símbol
+            load->symbol_of[token->symbol] = intern_symbol(lexeme);
+        }
+        symbol = load->symbol_of[token->symbol];
+    }
+    int before = status.all_tokens.count;
+    add_symbol_token_to_list(lexeme, token->len, cat, symbol);
+    if (status.all_tokens.count > before) {
+        status.all_tokens.tokens[before].line = token->line;
+    }
+}
+
+/* -------------------------------------------------------------------------
+ * Scans a .c file with the scanner (module_api, in memory) and adds its
+ * tokens to status.all_tokens: the same tokens as parsing its .cscnb.
+ * ------------------------------------------------------------------------- */
+int load_tokens_from_source(const char* filename) {
+    SourceLoad load = {NULL, 0, false};
+    status.all_tokens.count = 0;
+    int result = scan_source_file(filename, add_source_token, &load);
+    free(load.symbol_of);
+    if (load.out_of_memory) {
+        fprintf(stderr, "Error: out of memory loading %s\n", filename);
+        return ERROR_RETURN;
+    }
+    return result;
+}
+
+/* -------------------------------------------------------------------------
+ * Empties status.all_tokens and frees what their lexemes point to: the
+ * .cscnb image and the lexeme store. Call it when the parse is over.
+ * ------------------------------------------------------------------------- */
+void unload_tokens(void) {
+    status.all_tokens.count = 0;
+    release_token_image();
+    free_lexemes();
 }
 
 /* -------------------------------------------------------------------------
  * Detects the file extension
  *   .cscn  -> load_tokens_from_file()   (parse scanner output file)
- *   .c     -> load_tokens_from_scan()   (run scanner in-memory)
+ *   .cscnb -> load_tokens_from_binary() (binary scanner output, mmap)
+ *   .c     -> load_tokens_from_source() (scanned here with module_api)
  * ------------------------------------------------------------------------- */
 int load_tokens(void) {
     char path[MAX_FILENAME], filename[MAX_FILENAME], extension[MAXFILEEXT];
@@ -129,11 +347,14 @@ int load_tokens(void) {
     if (strcmp(extension, "cscn") == 0) {
         return load_tokens_from_file(status.ifile_name);
 
-    } else if (strcmp(extension, "c") == 0) { //scanner first
-        return load_tokens_from_scan();
+    } else if (strcmp(extension, "cscnb") == 0) {
+        return load_tokens_from_binary(status.ifile_name);
+
+    } else if (strcmp(extension, "c") == 0) { //scanner first, in memory
+        return load_tokens_from_source(status.ifile_name);
 
     } else {
-        fprintf(stderr, "Error: unsupported file extension '.%s'. Use .cscn or .c\n", extension);
+        fprintf(stderr, "Error: unsupported file extension '.%s'. Use .cscn, .cscnb or .c\n", extension);
         return ERROR_RETURN;
     }
-}
\ No newline at end of file
+}
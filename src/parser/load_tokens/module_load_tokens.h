@@ -12,6 +12,13 @@
  *     <if, CAT_KEYWORD> <(, CAT_SPECIALCHAR> <x, CAT_IDENTIFIER>
  *     <3, CAT_NUMBER> <+, CAT_OPERATOR>
  *
+ * .cscnb format (scanner -binary): header, string table and fixed-size
+ *   records (see CscnHeader/CscnRecord in config.h). It is mapped with mmap
+ *   and stays mapped while parsing: the tokens point to its lexemes.
+ *   Repeated lexemes are stored once and keep their symbol ID.
+ *
+ * .c files are scanned in memory with the scanner's module_api (scan_source.c).
+ *
  * Generic token/list operations (add_token_to_list, etc.) live in config.c.
  * This module only handles the file parsing logic.
  *
@@ -25,8 +32,11 @@
 
 #include "../config.h"
 
-static int read_field(FILE* f, char* buf, int len, char stop);
+static int read_field(FILE* f, char** buf, int* size, char stop);
 int load_tokens_from_file(const char* filename);
+int load_tokens_from_binary(const char* filename);
+int load_tokens_from_source(const char* filename);
 int load_tokens(void);
+void unload_tokens(void);
 
 #endif // MODULE_LOAD_TOKENS_H
\ No newline at end of file
@@ -0,0 +1,85 @@
+/*
+ * -----------------------------------------------------------------------------
+ * scan_source.c
+ *
+ * Scans a C source file for the Parser with the scanner's module_api
+ * (scanner_open / scanner_next): the file is read into memory and its tokens
+ * are pulled one at a time. module_api only links scanner_core, which has no
+ * status nor any other global of the scanner, so it links with the parser.
+ *
+ * Only the scanner's headers are included here (see scan_source.h).
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include "scan_source.h"
+#include "module_api.h"
+#include <limits.h>
+
+/* -------------------------------------------------------------------------
+ * Reads the whole file into a malloc'ed buffer (*len bytes). NULL if it can
+ * not be read or does not fit in an int (module_api offsets).
+ * ------------------------------------------------------------------------- */
+static char* read_source(const char* filename, int* len) {
+    FILE* f = fopen(filename, "rb");
+    if (!f) {
+        fprintf(stderr, "File not found: %s\n", filename);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* data = size >= 0 && size < INT_MAX ? malloc(size > 0 ? (size_t)size : 1) : NULL;
+    if (!data || fread(data, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "Error: could not read %s\n", filename);
+        free(data);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+    *len = (int)size;
+    return data;
+}
+
+/* -------------------------------------------------------------------------
+ * Prints the lexical error of a token as the scanner's error list words it.
+ * ------------------------------------------------------------------------- */
+static void print_lexical_error(const char* filename, const ScannerToken* tok) {
+    if (tok->error == ERR_NUL_BYTE) {   // %.*s s'aturaria al '\0'
+        fprintf(stderr, "Error: %s:%d:%d: NUL byte '\\0' in the input\n", filename, tok->line, tok->column);
+        return;
+    }
+    const char* what = tok->error == ERR_UNTERMINATED_LITERAL ? "Unterminated literal"
+                     : tok->error == ERR_TOKEN_TOO_LONG ? "Token too long"
+                     : "Non-recognized token";
+    int shown = tok->len < MAX_LINE_LENGTH ? tok->len : MAX_LINE_LENGTH;
+    fprintf(stderr, "Error: %s:%d:%d: %s '%.*s%s'\n", filename, tok->line, tok->column, what,
+            shown, tok->lexeme, shown < tok->len ? "..." : "");
+}
+
+int scan_source_file(const char* filename, SourceTokenSink add, void* context) {
+    int len;
+    char* data = read_source(filename, &len);
+    if (!data) {
+        return ERROR_RETURN;
+    }
+    Scanner* scanner = scanner_open(data, len, ENGINE_COMBINED);
+    free(data);     // scanner_open en fa una còpia
+    if (!scanner) {
+        fprintf(stderr, "Error: out of memory scanning %s\n", filename);
+        return ERROR_RETURN;
+    }
+
+    ScannerToken tok;
+    while (scanner_next(scanner, &tok)) {
+        if (tok.error != ERR_NONE) {
+            print_lexical_error(filename, &tok);
+        }
+        SourceToken token = {tok.lexeme, tok.len, (int)tok.cat, tok.line, tok.symbol};
+        add(&token, context);
+    }
+    scanner_close(scanner);
+    return CORRECT_RETURN;
+}
@@ -0,0 +1,42 @@
+/*
+ * -----------------------------------------------------------------------------
+ * scan_source.h
+ *
+ * Tokens of a C source file for the Parser, scanned in memory with the
+ * scanner's module_api (no scanner run, no .cscn file in between).
+ *
+ * The scanner and the parser have their own config.h (same guard, different
+ * Token, Category, status...), so this header includes neither of them: the
+ * tokens come as SourceToken and module_load_tokens.c adds them to
+ * status.all_tokens.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef SCAN_SOURCE_H
+#define SCAN_SOURCE_H
+
+#include <stdbool.h>
+
+typedef struct SourceToken {
+    const char* lexeme;     // len bytes (not NUL-terminated), valid only during the call
+    int len;
+    int cat;                // Category of the scanner: same values as the .cscnb records
+    int line;
+    int symbol;             // Same lexeme = same ID (from 0) in this file, -1 if not interned
+} SourceToken;
+
+// Called once per token, in order
+typedef void (*SourceTokenSink)(const SourceToken* token, void* context);
+
+/**
+ * Scans the whole file and passes every token to add. The lexical errors are
+ * printed to stderr (file:line:column) and their tokens still passed, as the
+ * scanner writes them to the .cscn.
+ * Returns 0 (CORRECT_RETURN), or -1 (ERROR_RETURN) if the file can not be read.
+ */
+int scan_source_file(const char* filename, SourceTokenSink add, void* context);
+
+#endif // SCAN_SOURCE_H
@@ -7,13 +7,13 @@
  * Program Flow:
  *   1. Parse arguments: expect a .cscn file path and optional language file
  *   2. Open output file  <stem>_p3dbg.txt
- *   3. Load tokens from the .cscn file into status.all_tokens
+ *   3. Load tokens from the .cscn / .cscnb file (or scan the .c file) into status.all_tokens
  *   4. (TODO) Load language from selected language file into a Language struct
  *   5. (TODO) Initialize SRA and run the parser driver
  *   6. Close output file
  *
  * Usage:
- *   parser <input_file.cscn> [language_file.txt]
+ *   parser <input_file.cscn|.cscnb|.c> [language_file.txt]
  *   parser -help
  *
  * Exit Codes:
@@ -32,7 +32,7 @@
  * Prints usage information to stdout.
  * ----------------------------------------------------------------------- */
 static void show_help(void) {
-    printf("Usage: parser <input_file.cscn> [language_file.txt]\n");
+    printf("Usage: parser <input_file.cscn|.cscnb|.c> [language_file.txt]\n");
     printf("Options:\n");
     printf("  -help    Display this help message\n");
     printf("\n");
@@ -110,8 +110,8 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
-    /* --- Load tokens from .cscn file ---------------------------------- */
-    if (load_tokens_from_file(status.ifile_name) != CORRECT_RETURN) {
+    /* --- Load tokens from .cscn (text), .cscnb (binary) or .c (scanned) - */
+    if (load_tokens() != CORRECT_RETURN) {
         fprintf(stderr, "Error: could not load tokens from '%s'\n", status.ifile_name);
         if (status.ofile) { fclose(status.ofile); status.ofile = NULL; }
         return 1;
@@ -164,6 +164,8 @@ int main(int argc, char *argv[]) {
     automatasra_driver(language);
     destroy_language(language); //revisar
     free(language);
+    unload_tokens();    // The lexemes of the tokens (.cscnb mapping, lexeme store)
+    free_symbols();
 
     /* --- Close output file --------------------------------------------- */
     if (status.ofile) {
@@ -74,7 +74,7 @@ ParseAction get_next_action(LanguageV2* language, Token token, RuleItemType* typ
         // otherwise                          -->  match by category
         int match = 0;
         if (vocab.token.cat == CAT_INDIFERENT) {
-            match = (strcmp(token.lexeme, vocab.token.lexeme) == 0);
+            match = same_lexeme(&token, &vocab.token);
         } else {
             match = (token.cat == vocab.token.cat);
         }
@@ -93,7 +93,7 @@ ParseAction get_next_action(LanguageV2* language, Token token, RuleItemType* typ
         RuleItem vocab = language->nonterminals[i][0]; // first slot holds the NT descriptor // Check if language.txt is correct here aswell
         int match = 0;
         if (vocab.token.cat == CAT_INDIFERENT) {
-            match = (strcmp(token.lexeme, vocab.token.lexeme) == 0);
+            match = same_lexeme(&token, &vocab.token);
         } else {
             match = (token.cat == vocab.token.cat);
         }
@@ -208,8 +208,7 @@ Token read_next_token(AutomataSRA* sra, int* returned){ //This input parameter c
         if (returned)
             *returned = EOTokenList;
         Token eof;
-        strncpy(eof.lexeme, EOF_TOKEN_LEXEME, MAX_TOKEN_NAME-1); // we could also use EOF_TOKEN_LEXEME // Check if in language.txt $ ==> EOF_TOKEN_LEXEME
-        eof.lexeme[MAX_TOKEN_NAME-1] = '\0'; 
+        set_token_lexeme(&eof, EOF_TOKEN_LEXEME); // Check if in language.txt $ ==> EOF_TOKEN_LEXEME
         eof.line = sra->tokens;
         eof.cat = CAT_INDIFERENT;
         return eof;
@@ -240,8 +239,8 @@ int write_update_to_output(Stack stack, Token tokn, ParseAction op){
     for (int i = 0; i < status.all_tokens.count && i < tokn.line; i++) {
         if (i > 0 && strlen(input) + 1 < MAX_INPUT_LENGTH - 1)
             strcat(input, " ");
-        if (strlen(input) + strlen(status.all_tokens.tokens[i].lexeme) < MAX_INPUT_LENGTH - 1)
-            strcat(input, status.all_tokens.tokens[i].lexeme);
+        if (strlen(input) + (size_t)status.all_tokens.tokens[i].len < MAX_INPUT_LENGTH - 1)
+            strncat(input, status.all_tokens.tokens[i].lexeme, (size_t)status.all_tokens.tokens[i].len);
     }
     
     // Get stack representation (from 0 to top)
@@ -254,10 +253,10 @@ int write_update_to_output(Stack stack, Token tokn, ParseAction op){
     
     // Write the formatted row to output file
     // Format: | State | Input | Read Token | Stack | Action |
-    fprintf(status.ofile, "| %5d | %-20s | %-10s | %-20s | %-10s |\n", 
+    fprintf(status.ofile, "| %5d | %-20s | %-10.*s | %-20s | %-10s |\n", 
             state, 
             input, 
-            tokn.lexeme,
+            tokn.len, tokn.lexeme,
             stack_str, 
             operation);
     
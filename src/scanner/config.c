@@ -8,6 +8,7 @@
  * Key Responsibilities:
  * - Global status variable initialization and management
  * - Token list management (adding, counting, storing tokens)
+ * - Symbol table of the tokens (status.symbols, see scan_index.c)
  * - Token buffer operations (creation, clearing, character addition)
  * - Category to string conversion for output formatting
  * - Token output to file and token list storage
@@ -27,7 +28,7 @@
 #include "config.h"
 #include "count.h"
 
-Status status;  // ← THIS allocates the memory (only once)
+_Thread_local Status status;  // ← THIS allocates the memory (one per thread: -batch scans a file per thread)
 
 //Our general functions
 const char* category_to_string(Category cat) {
@@ -44,103 +45,133 @@ const char* category_to_string(Category cat) {
     }
 }
 
-void add_token_to_list(char* lexeme, Category cat) {
+void add_token_to_list(const Token* token) {
+    ListTokens *list = &status.all_tokens;
     COUNT_COMP(1);
-    if (status.all_tokens.count >= MAX_TOKENS) {
-        report_warning("Maximum token count reached, token discarded", status.line, SCANNER_STEP);
-        return;
+    if (list->count == list->capacity) { // Ple: doblem la capacitat de tots els arrays
+        int capacity = list->capacity ? list->capacity * 2 : 1024;
+        uint8_t *cat = realloc(list->cat, capacity * sizeof(uint8_t));
+        if (cat) list->cat = cat;
+        int *offset = realloc(list->offset, capacity * sizeof(int));
+        if (offset) list->offset = offset;
+        int *len = realloc(list->len, capacity * sizeof(int));
+        if (len) list->len = len;
+        int *symbol = realloc(list->symbol, capacity * sizeof(int));
+        if (symbol) list->symbol = symbol;
+        COUNT_GEN(5);
+        COUNT_COMP(1);
+        if (!cat || !offset || !len || !symbol) {
+            report_warning("Out of memory for the token list, token discarded", line_of_offset(&status.lines, token->offset), SCANNER_STEP);
+            return;
+        }
+        list->capacity = capacity;
     }
 
-    Token *t = &status.all_tokens.tokens[status.all_tokens.count];
-
-    strncpy(t->lexeme, lexeme, MAX_TOKEN_NAME - 1);
-    t->lexeme[MAX_TOKEN_NAME - 1] = '\0';  // ensure termination
-
-    t->cat = cat;
-    t->line = status.line;
+    list->cat[list->count] = (uint8_t)token->cat;
+    list->offset[list->count] = token->offset;
+    list->len[list->count] = token->len;
+    COUNT_COMP(1);
+    list->symbol[list->count] = is_symbol_category(token->cat)
+                              ? symbol_table_intern(&status.symbols, status.input, token->offset, token->len)
+                              : NO_SYMBOL;
 
-    status.all_tokens.count++;
-    COUNT_GEN(6);
+    list->count++;
+    COUNT_GEN(5);
 }
 
-
-void buffer_clear(BufferAuto *buffer) {
-    buffer->len = 0;
-    buffer->lexeme[0] = '\0';
-    COUNT_GEN(2);
+void free_token_list(ListTokens* list) {
+    free(list->cat);
+    free(list->offset);
+    free(list->len);
+    free(list->symbol);
+    memset(list, 0, sizeof(*list));
 }
 
-void buffer_add(BufferAuto *buffer, char c) {
-    if (buffer->len < MAX_TOKEN_NAME - 1) {
-        buffer->lexeme[buffer->len++] = c;
-        buffer->lexeme[buffer->len] = '\0';
-    } else {
-        report_warning("Token too long, character discarded", status.line, SCANNER_STEP);
+/**
+ * Writes status.all_tokens in the binary .cscnb format (see CscnHeader in config.h)
+ * Lexemes are read from status.input, so it has to be called before freeing it
+ */
+int write_tokens_binary(const char* filename) {
+    const ListTokens *list = &status.all_tokens;
+    FILE *f = fopen(filename, "wb");
+    COUNT_IO(1);
+    if (!f) {
+        report_error_typed(ERR_FILE_NOT_FOUND, 0, SCANNER_STEP);
+        return ERROR_RETURN;
     }
-}
 
-void buffer_append(BufferAuto *dest, const BufferAuto *src) { //Does not delete the contents of the original buffer
-    int i = 0;
-    while (i < src->len && dest->len < MAX_TOKEN_NAME - 1) {
-        dest->lexeme[dest->len++] = src->lexeme[i++];
+    const SymbolTable *symbols = &status.symbols;
+    uint32_t* symbol_string = malloc(((size_t)symbols->count + 1) * sizeof(uint32_t)); // Offset de cada símbol a la taula
+    if (!symbol_string) {
+        fclose(f);
+        report_error("Out of memory for the binary token file", 0, SCANNER_STEP);
+        return ERROR_RETURN;
     }
-    dest->lexeme[dest->len] = '\0';
-}
-
-void buffer_move_append(BufferAuto *dest, BufferAuto *src) { //Does "delete" it, like it moves the content from one to another
-    int i = 0;
-    while (i < src->len && dest->len < MAX_TOKEN_NAME - 1) {
-        dest->lexeme[dest->len++] = src->lexeme[i++];
-        COUNT_GEN(1);
-        COUNT_COMP(2);
+    uint32_t strings_size = 0;
+    for (int id = 0; id < symbols->count; id++) { // Cada lexema internat un sol cop
+        symbol_string[id] = strings_size;
+        strings_size += (uint32_t)symbols->len[id] + 1;
     }
-    dest->lexeme[dest->len] = '\0';
-    COUNT_GEN(1);
-
-    buffer_clear(src);
-}
-
-ActionSkip skip_nonchars(char c, char lookahead){
-    ActionSkip action = {0};  // Initialize all members to 0
-    bool saw_newline = false;
-    
-    while (c == SPACE_CHAR || c == TAB_CHAR || c == END_OF_LINE || c == CARRIAGE_RETURN) {
-        COUNT_COMP(1);
-        if (c == END_OF_LINE || c == CARRIAGE_RETURN) {
-            status.line++;
-            saw_newline = true;  // Track that we saw a newline
-            COUNT_GEN(2);  
+    uint32_t lexeme = strings_size;    // Lexemes no internats, després dels símbols
+    for (int i = 0; i < list->count; i++) {
+        if (list->symbol[i] == NO_SYMBOL) {
+            strings_size += (uint32_t)list->len[i] + 1;
         }
-        c = lookahead;
-        COUNT_COMP(1);  
-        COUNT_IO(1);  
-        if (lookahead != EOF) {
-            lookahead = fgetc(status.ifile);
+    }
+    uint32_t padding = (4 - strings_size % 4) % 4;
+
+    CscnHeader header = {0};
+    memcpy(header.magic, CSCN_MAGIC, 4);
+    header.version = CSCN_VERSION;
+    header.num_tokens = (uint32_t)list->count;
+    header.strings_offset = sizeof(CscnHeader);
+    header.strings_size = strings_size;
+    header.records_offset = header.strings_offset + strings_size + padding;
+    header.num_symbols = (uint32_t)symbols->count;
+    fwrite(&header, sizeof(header), 1, f);
+
+    for (int id = 0; id < symbols->count; id++) { // String table: primer els símbols
+        fwrite(status.input + symbols->offset[id], 1, symbols->len[id], f);
+        fputc('\0', f);
+    }
+    for (int i = 0; i < list->count; i++) { // i després els lexemes no internats
+        if (list->symbol[i] == NO_SYMBOL) {
+            fwrite(status.input + list->offset[i], 1, list->len[i], f);
+            fputc('\0', f);
         }
     }
-    
-    COUNT_COMP(1); 
-    if (c == EOF) {
-        action.c = EOF;
-        action.lookahead = EOF;
-        action.to_do = EOF_RETURN;
-        COUNT_GEN(3);
-    } else {
-        action.c = c;
-        action.lookahead = lookahead;
-        COUNT_COMP(1);
-        if (saw_newline){
-            action.to_do = action.to_do = EOL_RETURN;
+    static const char zeros[4] = {0};
+    fwrite(zeros, 1, padding, f);
+
+    int newlines = 0;   // '\n' abans del token (els tokens van en ordre, la cerca continua des d'aquí)
+    for (int i = 0; i < list->count; i++) { // Records
+        CscnRecord record = {0};
+        record.cat = list->cat[i];
+        newlines = line_index_seek(&status.lines, newlines, list->offset[i]);
+        record.line = (uint32_t)newlines + 1;
+        record.len = (uint32_t)list->len[i];
+        if (list->symbol[i] == NO_SYMBOL) {
+            record.symbol = CSCN_NO_SYMBOL;
+            record.lexeme = lexeme;
+            lexeme += record.len + 1;
         } else {
-            action.to_do = action.to_do = CORRECT_RETURN;
+            record.symbol = (uint32_t)list->symbol[i];
+            record.lexeme = symbol_string[list->symbol[i]];
         }
-        COUNT_GEN(2);
+        fwrite(&record, sizeof(record), 1, f);
+    }
+    free(symbol_string);
+    COUNT_IO(2 * symbols->count + 3 * list->count + 2);
+    COUNT_GEN(7 * list->count + 2 * symbols->count);
+
+    bool write_error = ferror(f) != 0;
+    if (fclose(f) != 0 || write_error) {
+        report_error("Could not write the binary token file", 0, SCANNER_STEP);
+        return ERROR_RETURN;
     }
-    return action;
+    return CORRECT_RETURN;
 }
 
-
-
 //Functions that were here in the template
 
 void split_path(const char *fullpath, char *path, char *filename, char *extension) {
@@ -23,6 +23,7 @@
  
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>     // To set env for time zone
 #include <string.h>     // For filename manipulation    
 #include <time.h>       // For time-stamp of output logs filenames
@@ -37,6 +38,9 @@
 #define DEBUG_F ON //On or OFF (defined below, I hope it is not a problem)
 #define OUTFORMAT_M DEBUG //MODE of outformat (RELEASE or DEBUG)
 #define COUNTOUT_F OUT //Explained below [OUT or DBGCOUNT] (in RELEASE Mode we not count)
+#ifndef COUNT_F   //scanner_core (module_api) is built with COUNT_F=OFF: no counters, no status
+#define COUNT_F ON //ON: COUNT_* macros count (only in DEBUG outformat); OFF: they compile to nothing
+#endif
 
 #define PARSER_F false //Should not change until P3 (it will either continue with the parser or not) [IGNORE FOR NOW]
 
@@ -58,18 +62,26 @@ DBGCOUNT: messages should be sent to the stdout file.
 //These ones should not be changed (well, not usually to compile)
 #define HELP_F "-help"
 #define ERRORS_F "-errors"
+#define LOCKSTEP_F "-lockstep"
+#define VECTOR_F "-vector"      //Lockstep engine with all the automata in one vector (benchmark against -lockstep)
+#define BINARY_F "-binary"
+#define JOBS_F "-jobs"          //Followed by the number of threads (-jobs 4)
+#define COUNTLOG_F "-countlog"  //Write a [COUNT] line for every increment (DEBUG, slow)
+#define COUNTTSV_F "-counttsv"  //Followed by a file: append the counts of the scan as TSV (baselines)
+#define BATCH_F "-batch"        //Every input file given is scanned, -jobs workers at the same time
+#define CACHE_F "-cache"        //Followed by a directory: outputs of earlier scans, reused when the input bytes are the same
 
 /////"String" lengths
 #define MAX_FILENAME 512        // Max File length (in bits I think) for compiler variables
 #define MAX_TOKEN_NAME 4096      // Max Key Length
-#define MAX_TOKENS 1024         // Max number of macros
+#define MAX_TOKEN_LEN (MAX_TOKEN_NAME - 1)  // Longest lexeme: a longer token is a runaway (one error, resync at the next line)
 #define MAX_LINE_LENGTH 4096    // Max length of a whole line
 // #define MAX_MACRO_VALUE 1024    // MAX Value Length
 
 #define MAX_FUNCTION_NAME 512
 #define MAX_ALPHABET_SIZE 512
 #define MAX_STATES 512
-#define MAX_AUTOMATAS 256
+#define MAX_AUTOMATAS 64     // One bit each in the AutomataList masks (= MAX_RULES in tablegen.c)
 
 #define MAXFILENAME 256 // Maximum length of the filename for output logs
 #define MAXFILEEXT 64   // Maximum length of the file extension
@@ -84,6 +96,7 @@ DBGCOUNT: messages should be sent to the stdout file.
 
 #define EOL_RETURN 4
 #define EOF_RETURN 5
+#define BATCH_RETURN 6  // init_program with -batch: each worker opens its own files
 
 
 //Other
@@ -107,7 +120,8 @@ typedef enum{
     ERR_TOKEN_TOO_LONG,
     ERR_UNTERMINATED_LITERAL,
     ERR_MAX_TOKENS_EXCEEDED,
-    ERR_EMPTY_FILE
+    ERR_EMPTY_FILE,
+    ERR_NUL_BYTE                    //'\0' inside the input (before input_len): a token of its own
 } Error;
 
 //Depending on this we print in a format or in another in the outputfile
@@ -125,8 +139,8 @@ typedef enum{
     CAT_KEYWORD,        //[a-zA-Z]+ (not sure if there can be numbers in keywords)
     CAT_TYPE,           //[a-zA-Z]+ (not sure if there can be numbers in keywords)
 	CAT_LITERAL,        // " ASCII " (really any string between "")
-	CAT_OPERATOR,       // = or > or + or *         ( i guess not - nor / nor < nor =< etcetc)
-	CAT_SPECIALCHAR,    // ( or ) or ; or { or } or [ or ] or ,
+	CAT_OPERATOR,       // Every C punctuator that is not a delimiter: = == <<= -> ++ && ... (tokens.spec)
+	CAT_SPECIALCHAR,    // ( or ) or ; or { or } or [ or ] or , (also the digraphs <: :> <% %>)
 	CAT_NONRECOGNIZED   // Does not fit in any of the previous
 } Category;
 
@@ -135,6 +149,13 @@ typedef enum{
     PARSER_STEP
 } Step;
 
+//Which engine moves the automata over the input
+typedef enum{
+    ENGINE_COMBINED,    // One combined DFA, one table transition per character (default)
+    ENGINE_LOCKSTEP,    // Every automaton stepped on its own (reference engine, -lockstep flag)
+    ENGINE_VECTOR       // Every automaton stepped at once, states packed in vector lanes (-vector flag)
+} Engine;
+
 // typedef enum{ //NOT SURE IF IT WILL BE NEEDED BE CAREFUL
 //     FLAG_HELP,
 // 	FLAG_DEBUG,
@@ -147,9 +168,13 @@ typedef enum{
 //Structs
 
 typedef struct Token {
-    char lexeme[MAX_TOKEN_NAME];    //Literal string (lexeme)    
     Category cat;                   //Category from the ones above
-    int line;                       //Line number where the token starts
+    int offset;                     //Start of the lexeme in the source buffer (status.input), not copied
+    int len;                        //Length of the lexeme (0 = no more tokens)
+                                    //The line is not stored: line_of_offset(&status.lines, offset)
+    Error error;                    //ERR_NONE, or the error found while scanning it (reported when written)
+    int reach;                      //Position right after the last byte read to decide it (lookahead and the
+                                    //bytes after a longest-match backtrack): an edit at or after it does not change it
     // bool is_defined; //Not sure if needed
 } Token;
 
@@ -159,12 +184,55 @@ typedef struct Token {
 //     int count;                      //I will leave the option to add any relevant parameter such as count
 // } IdendifierDict;
 
+//Interned lexemes (symbol table): identifiers, keywords, types and literals get the ID of their
+//lexeme, the same for every occurrence, so repeated names are stored once and compared by ID
+#define NO_SYMBOL (-1)      //Symbol ID of the tokens of the other categories
+
+static inline bool is_symbol_category(Category cat) {
+    return cat == CAT_IDENTIFIER || cat == CAT_KEYWORD || cat == CAT_TYPE || cat == CAT_LITERAL;
+}
+
+//Open addressing hash table; the lexeme of a symbol is its first occurrence in the input
+typedef struct SymbolTable {
+    int* offset;        //Lexeme of symbol i = input[offset[i] .. offset[i] + len[i])
+    int* len;
+    uint32_t* hash;     //Hash of each symbol (the slots are rebuilt without reading the lexemes)
+    int count;          //Symbol IDs are 0 .. count - 1, in order of first occurrence
+    int capacity;
+    int* slots;         //Symbol ID + 1 of each slot (0 = empty), num_slots is a power of two
+    int num_slots;
+} SymbolTable;
+
 //List of tokens as thy appear in the ifile
+//Struct of arrays (one array per field) that grows when it is full: ~13 bytes per token, no limit
 typedef struct ListTokens {
-    Token tokens[MAX_TOKENS];
+    uint8_t* cat;       //Category of each token
+    int* offset;        //Lexeme = status.input[offset .. offset + len)
+    int* len;
+    int* symbol;        //Symbol ID in status.symbols, NO_SYMBOL if the category is not interned
     int count;
+    int capacity;
 } ListTokens;
 
+//Offsets of every '\n' of the input, built by automata_driver before scanning (build_line_index, vectorized)
+//Lines and columns are computed from an offset only when they are needed (output, errors)
+typedef struct LineIndex {
+    int* newlines;      //Offsets in increasing order
+    int count;
+    int capacity;
+    bool ascii;         //Only ASCII bytes (build_line_index): a column is a byte distance
+    int invalid_utf8;   //Bytes that do not belong to a valid UTF-8 sequence
+    int first_invalid_utf8; //Offset of the first one, -1 if none
+} LineIndex;
+
+//Column of the tokens pulled in order (module_api): only the bytes since the last one are read
+//All zero is a valid cursor (offset 0 of the first line)
+typedef struct ColumnCursor {
+    int line_start;     //Offset of the first character of the line of offset
+    int offset;
+    int before;         //Characters of the line before offset (column - 1)
+} ColumnCursor;
+
 //This probably still needs things to be changed but for now we have this
 //To count the input and output calls; The number of operations done etc etc
 //Should create a "main" one and a new one each time we call a function and then add all the counters to the "main" counter once the function finishes
@@ -189,67 +257,129 @@ typedef struct {
 
 	char ifile_name[MAX_FILENAME]; 
 	char ofile_name[MAX_FILENAME];
+    char bfile_name[MAX_FILENAME];  //Binary token file (<ifile>scnb), only written with -binary
 	FILE* ifile;
 	FILE* ofile;
+    char* input;        //Whole input file, read once at init and ended with '\0' (scan_token works over it)
+    int input_len;
     FILE* error_file;
 
     ListTokens all_tokens;
+    SymbolTable symbols;    //Interned lexemes of all_tokens
+    LineIndex lines;    //'\n' offsets of input
 
-	int line;           //In which line are we
+	int line;           //Line of the last token written (status.line - 1 = '\n' before it)
 
     bool first_token_in_line ; //First token of the line
     bool line_has_tokens; //Si la línia té tokens (per no imprimir línies buides en RELEASE) 
+
+    Engine engine;      //Engine of the flags (copied to the AutomataList by init_automata)
+    bool binary_out;    //Also write the tokens in the binary format (-binary)
+    int jobs;           //Threads to scan the input in chunks (-jobs N); 0 or 1 = sequential
+                        //With -batch: number of workers (0 = one per processor)
+    bool count_log;     //-countlog: trace every count increment, not only the summary
+    char count_tsv[MAX_FILENAME];   //-counttsv: file where the counts are appended ("" = none)
+    char cache_dir[MAX_FILENAME];   //-cache: directory of cached outputs, keyed by a hash of the input ("" = none)
+    bool batch;         //-batch: scan every file of batch_files
+    char** batch_files; //Input files given with -batch (point to argv)
+    int num_batch_files;
 	// bool last_in_line;  //Last Token of the line
     // bool in_string;
     // bool type_icv;      //Know if we are after an int, char or void declaration
 } Status;
 
-typedef struct StateRow {
-    int new_state[MAX_ALPHABET_SIZE]; // Contains a state_number for each state-char pair S0_row = [1,0,3,0,2] (assume symbols from the alphabet are always in the same order)
-} StateRow;
-//???SHOULD BE [MAX_ALPHABET_SIZE] INSTEAD OF [MAX_STATES] ??????????????
-
-typedef struct TransitionMatrix {
-    StateRow states_rows[MAX_STATES]; // Contains a row for each state in the DFA [S0_row, S1_row, S2_row, ...]
-    int width; //Number of symbols
-    int height; //Number of states
-} TransitionMatrix;
-
-typedef struct SymbolVocab {
-    char character;
-    int column;
-} SymbolVocab;
-
 typedef struct AutomataDFA {
-    SymbolVocab alphabet[MAX_ALPHABET_SIZE];        //
-    int states[MAX_STATES];                         // [0,1,2,3] {could be just an int, but idk just in case}
-    int start_state;                                // 1
-    int current_state;                              // current_state (cs) changes when we read characters (cs == 1 and read w --> cs == 2)
-    int accepting_states[MAX_STATES];               // [3] {could be more}
-    TransitionMatrix matrix;                        // [[2,7,7,7,7],[7,3,7,7,7],[7,7,4,7,7],[7,7,7,5,7],[7,7,7,7,6],[7,7,7,7,7],[7,7,7,7,7]]
+    const uint8_t* class_of;                        // byte -> column (CLASS_OF, shared by all the generated tables)
+    const uint8_t* transitions;                     // height rows of width cells, row-major: transitions[state * width + column]
+    const uint8_t* accepting;                       // Bitset of accepting states: bit (state & 7) of accepting[state >> 3]
+    uint8_t width;                                  // Number of columns (byte classes)
+    uint8_t height;                                 // Number of states (0 = dead state)
+    uint8_t start_state;                            // 1
     Category type;                                  // CAT_KEYWORD (it is an enum, so include config.h to have the struct)
-    bool dont_look_anymore;                         // If we have already finished the execution and we do not want to keep looking
-} AutomataDFA;
+} AutomataDFA;                                      // Read only: shared by every scan (and thread)
 
+//State of one automaton during a scan (lockstep engine); the tables above are not modified
+typedef struct AutomataCursor {
+    int current_state;                              // current_state (cs) changes when we read characters (cs == 1 and read w --> cs == 2)
+} AutomataCursor;
 
+//Automata of one scan: shared tables + its own cursors (one AutomataList per scan/thread)
 typedef struct AutomataList {
-    AutomataDFA* automatas[MAX_AUTOMATAS];  
+    const AutomataDFA* automatas[MAX_AUTOMATAS];  
+    AutomataCursor cursors[MAX_AUTOMATAS];          // cursors[i] is the state of automatas[i]
     int num_automata;
+    uint64_t first_byte[256];                       // Bit i: automatas[i] can start a token with that byte
+    uint64_t active;                                // Bit i: automatas[i] is still running in this token
+    Engine engine;                                  // Engine scan_token runs with this list
 } AutomataList;
 
-extern AutomataDFA* ALL_AUTOMATA[];
-extern int NUM_AUTOMATA;
+extern const AutomataDFA* const ALL_AUTOMATA[];
+extern const int NUM_AUTOMATA;
+extern const uint64_t FIRST_BYTE_AUTOMATA[256];     // Same bits for ALL_AUTOMATA (generated)
+
+//The same automata interleaved for the vector engine: lane i = ALL_AUTOMATA[i]
+//One gather per byte reads the next state of every lane ([class][state][lane]); the dead
+//state (0) only goes to itself, so lanes that stopped just stay at 0.
+#define VECTOR_LANES 8              // 32-bit states in one AVX2 register (= VECTOR_LANES in tablegen.c)
+#define VECTOR_ACCEPT 0x100         // Cell bit: the next state is accepting (= VECTOR_ACCEPT in tablegen.c)
+#define VECTOR_STATE_MASK 0xFF      // Cell bits of the next state (AutomataDFA states are uint8_t)
+
+typedef struct VectorAutomata {
+    const uint8_t* class_of;        // byte -> symbol class (same CLASS_OF as the automata)
+    int num_lanes;                  // NUM_AUTOMATA rounded up to VECTOR_LANES (padding lanes are dead)
+    int num_states;                 // States of every lane (the tallest automaton)
+    const int32_t* next;            // [class][state][lane] -> next state | VECTOR_ACCEPT
+    const int32_t* start;           // [lane] -> start state (0 for padding lanes)
+    const signed char* type;        // [lane] -> Category of the automaton
+} VectorAutomata;
+
+extern const VectorAutomata VECTOR_AUTOMATA;
+
+//Combined DFA of all the token rules (generated with the rest of the tables from tokens.spec)
+//A token ends when the transition with the lookahead goes to the dead state (0); it is accepted
+//with the category of its accepting state (highest priority rule), otherwise it is non-recognized.
+#define COMBINED_CONTINUE -1    // Token still open
+#define COMBINED_REJECT -2      // Token finished but no rule accepts it, lexeme is non-recognized
+
+#define MAX_RUN_STOPS 3    // Stop bytes of a run state (= MAX_RUN_STOPS in tablegen.c)
+
+typedef struct CombinedDFA {
+    const uint8_t* class_of;        // byte -> symbol class (same CLASS_OF as the automata)
+    int num_classes;
+    int num_states;
+    int start_state;
+    const short* next_state;        // [state][class] -> next state (0 = dead)
+    const signed char* accept;      // [state] -> accepted Category, or -1
+    // Run states loop on themselves with every byte except a few stop bytes (e.g. a literal
+    // body, stop '"'); the driver jumps to the next stop byte with find_run_end
+    const signed char* run_stops;   // [state] -> number of stop bytes, or -1 if not a run state
+    const uint8_t (*run_stop)[MAX_RUN_STOPS]; // [state] -> stop bytes ('\0' always stops)
+    const signed char* pending;     // [state] -> highest priority Category still possible, or -1
+} CombinedDFA;
+
+extern const CombinedDFA COMBINED_AUTOMATA;
+
+//Reserved words (keywords, types) are recognized by the IDENTIFIER rule and then looked up
+//in this perfect hash table (generated from the "words" lines of tokens.spec)
+typedef struct ReservedWord {
+    const char* word;               // NULL in empty slots
+    int len;
+    Category cat;
+} ReservedWord;
+
+extern const ReservedWord RESERVED_WORDS[];
+extern const uint32_t RESERVED_SEED;
+extern const uint32_t RESERVED_MASK;
+extern const int RESERVED_MAX_LEN;
 
 
 /*
 
-//DFA IF
-alphabet:           ["i", "f"]      ==>  i = position_0_in_array ; f = position_1_in_array
-states:             [1,2,3,4]       //4 == conjunt_buit state
-start_state:        1
-accepting_states:   [3]
-la_acceptance:      ["(", " "]
-TM:                 [[2,4],[4,3],[4,4],[4,4]]
+//DFA IF  (tokens.spec:  KEYWORD 6 if)
+class_of:           ['i'] = 1, ['f'] = 2, rest = 0
+start_state:        1               //0 == conjunt_buit (dead) state
+accepting:          {0x08}          //bit 3 ==> state 3
+transitions:        [0,0,0, 0,2,0, 0,0,3, 0,0,0]   //4 rows of width (3) cells
 Category:           CAT_KEYWORD
 
 */
@@ -272,24 +402,35 @@ typedef struct CountReport {
 } CountReport;
 
 
-//helper structs
-typedef struct Two_ints {
-    int actual;
-    int lookahead;
-} Two_ints;
-
-typedef struct BufferAuto {
-    char lexeme[MAX_TOKEN_NAME];
-    int len;
-} BufferAuto;
-
-typedef struct ActionSkip {
-    int c;
-    int lookahead;
-    int to_do;
-} ActionSkip;
-
-extern Status status;   // declaration, NOT definition
+//Binary token file (-binary): <ifile>scnb, loaded by the parser with mmap (text .cscn is still written)
+//Layout: CscnHeader | string table (lexemes, each ended in '\0') | CscnRecord[num_tokens]
+//The string table starts with the num_symbols interned lexemes, each one once (in ID order),
+//followed by the lexemes of the tokens that are not interned
+//Integers are stored in the machine byte order. Same structs in src/parser/config.h
+#define CSCN_MAGIC "CSCN"
+#define CSCN_VERSION 2
+#define CSCN_NO_SYMBOL 0xFFFFFFFFu
+
+typedef struct CscnHeader {
+    char magic[4];              // CSCN_MAGIC (no '\0')
+    uint32_t version;
+    uint32_t num_tokens;
+    uint32_t strings_offset;    // From the start of the file
+    uint32_t strings_size;
+    uint32_t records_offset;    // Multiple of 4, so records can be read in place
+    uint32_t num_symbols;       // Interned lexemes (symbol IDs 0 .. num_symbols - 1)
+} CscnHeader;
+
+typedef struct CscnRecord {
+    uint8_t cat;                // Category
+    uint8_t reserved[3];
+    uint32_t line;
+    uint32_t lexeme;            // Offset of the lexeme in the string table
+    uint32_t len;               // Length of the lexeme (without the '\0')
+    uint32_t symbol;            // Symbol ID (same lexeme = same ID), CSCN_NO_SYMBOL if not interned
+} CscnRecord;
+
+extern _Thread_local Status status;   // declaration, NOT definition (each thread has its own)
 
 // Path to the logs directory: put your full path, the directory has to exist
 //#define PATHDIRLOGS "I:/Mi unidad/UPFdrive/docencia/github/compilers/modules_template/logs/" 
@@ -300,16 +441,27 @@ FILE* set_output_test_file(const char* filename);
 
 const char* category_to_string(Category cat);
 
-void add_token_to_list(char* lexeme, Category cat);
+void add_token_to_list(const Token* token);
+
+void free_token_list(ListTokens* list);
+
+int symbol_table_intern(SymbolTable* table, const char* input, int offset, int len);
+
+void free_symbol_table(SymbolTable* table);
+
+int line_index_seek(const LineIndex* index, int from, int offset);
 
-void buffer_clear(BufferAuto *buffer);
+int line_of_offset(const LineIndex* index, int offset);
 
-void buffer_add(BufferAuto *buffer, char c);
+int column_of_offset(const LineIndex* index, const char* input, int offset);
 
-void buffer_append(BufferAuto *dest, const BufferAuto *src);
+int column_cursor_seek(ColumnCursor* cursor, const LineIndex* index, const char* input, int newlines, int offset);
 
-void buffer_move_append(BufferAuto *dest, BufferAuto *src);
+int write_tokens_binary(const char* filename);
 
-ActionSkip skip_nonchars(char c, char lookahead);
+// True for the characters skipped between tokens
+static inline bool is_blank_char(char c){
+    return c == SPACE_CHAR || c == TAB_CHAR || c == END_OF_LINE || c == CARRIAGE_RETURN;
+}
 
 #endif // CONFIG_FILES_H
\ No newline at end of file
@@ -8,7 +8,11 @@
  *
  * Key Features:
  * - Initialize and finalize counting system
- * - Track operation counts by type and location
+ * - Track operation counts by type and location (in memory, one slot per
+ *   function cached at each call site, written at count_finalize)
+ * - Optional trace of every increment (-countlog)
+ * - Counts of the -jobs chunks (made on other threads) merged into the scan
+ * - Counts appended to a TSV file (-counttsv), used by the count baseline test
  * - Support for separate debug count file or main output
  * - Operation counting macros for conditional compilation
  * - Counter statistics output
@@ -29,50 +33,56 @@
 #include <string.h>
 #include <stdbool.h>
 
-// Global counting state
-CountConfig global_count_config = {0};
+#ifndef _WIN32
+    #include <pthread.h>
+#endif
 
-// Flag to track if counting system has been initialized
-static bool count_initialized = false;
+// Global counting state (per thread, like status: every file scanned in -batch has its own count)
+_Thread_local CountConfig global_count_config = {0};
+_Thread_local CountState count_state = {0};
 
-// Per-function counting tracking
-#define MAX_FUNCTIONS 100
-
-typedef struct {
-    char name[MAX_FUNCTION_NAME];
-    CountVars counts;
-    bool active;
-} FunctionRecord;
-
-static FunctionRecord function_records[MAX_FUNCTIONS] = {0};
+// Function names of the slots: shared by all the threads, so the slot cached by a call site is
+// valid in every scan. __func__ strings live for the whole program, only the pointer is kept
+static const char* function_names[MAX_COUNT_FUNCTIONS + 1];
 static int num_functions = 0;
+#ifndef _WIN32
+static pthread_mutex_t functions_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
 
 /**
- * Find or create a function record for tracking per-function counts
+ * Slot of a function (created the first time). Only called once per call site and thread
  * @param func_name Name of the function
- * @return Pointer to the function record, or NULL if table is full
+ * @return Slot in count_state.functions; the last slot is shared when the table is full
  */
-static FunctionRecord* get_function_record(const char* func_name) {
-    // Search for existing record
+int count_register(const char* func_name) {
+#ifndef _WIN32
+    pthread_mutex_lock(&functions_lock);
+#endif
+    int slot = MAX_COUNT_FUNCTIONS;
     for (int i = 0; i < num_functions; i++) {
-        if (strcmp(function_records[i].name, func_name) == 0) {
-            return &function_records[i];
+        if (strcmp(function_names[i], func_name) == 0) {
+            slot = i;
+            break;
         }
     }
-    
-    // Create new record if space available
-    if (num_functions < MAX_FUNCTIONS) {
-        FunctionRecord* record = &function_records[num_functions++];
-        strncpy(record->name, func_name, MAX_FUNCTION_NAME - 1);
-        record->name[MAX_FUNCTION_NAME - 1] = '\0';
-        record->counts.countcomp = 0;
-        record->counts.countio = 0;
-        record->counts.countgen = 0;
-        record->active = true;
-        return record;
+    if (slot == MAX_COUNT_FUNCTIONS && num_functions < MAX_COUNT_FUNCTIONS) {
+        slot = num_functions++;
+        function_names[slot] = func_name;
     }
-    
-    return NULL; // Table full
+#ifndef _WIN32
+    pthread_mutex_unlock(&functions_lock);
+#endif
+    return slot;
+}
+
+static const char* slot_name(int slot) {
+    return slot < MAX_COUNT_FUNCTIONS ? function_names[slot] : "(other functions)";
+}
+
+// First increment of the slot in this scan: the summary lists functions in this order
+void count_first_use(int slot) {
+    count_state.used[slot] = true;
+    count_state.order[count_state.num_used++] = slot;
 }
 
 /**
@@ -83,7 +93,7 @@ static FunctionRecord* get_function_record(const char* func_name) {
 void count_init(const char* ifile_name, bool countout_flag) {
     if (status.oform != DEBUG) return;
 
-    if (count_initialized) {
+    if (count_state.active) {
         fprintf(stderr, "[COUNT WARNING] count_init called twice, skipping re-initialization\n");
         return;
     }
@@ -115,74 +125,116 @@ void count_init(const char* ifile_name, bool countout_flag) {
         global_count_config.countifle = status.ofile;
     }
     
-    count_initialized = true;
+    count_state.active = true;
+    count_state.log = status.count_log;
     
     // Print initialization message
     FILE* out = global_count_config.countifle ? global_count_config.countifle : stdout;
     fprintf(out, "[COUNT] === Operation Counting Initialized ===\n");
     fprintf(out, "[COUNT] Mode: %s\n", countout_flag == DBGCOUNT ? "DBGCOUNT (separate file)" : "OUT (main output)");
-    fprintf(out, "[COUNT] Format: line=<num> func=<name> +<amount> <type> | partial: comp io gen | total: comp io gen\n");
+    if (count_state.log) {
+        fprintf(out, "[COUNT] Format: line=<num> func=<name> +<amount> <type> | partial: comp io gen | total: comp io gen\n");
+    }
     fprintf(out, "[COUNT] ==========================================\n");
     fflush(out);
 }
 
 /**
- * Increment a counter and optionally report the increment
- * @param func_name Name of the function where counting occurs
- * @param line Line number in source file
- * @param amount Amount to increment
- * @param counter_type Type of counter: "COMP", "IO", or "GEN"
+ * Writes one increment (-countlog), after it has been added to the counters
+ * @param slot Slot of the function where counting occurs
+ * @param amount Amount incremented
+ * @param type Type of counter: COMP, IO or GEN
  */
-void count_increment(const char* func_name, int line, int amount, const char* counter_type) {
-    if (!count_initialized) {
-        fprintf(stderr, "[COUNT ERROR] count_increment called before count_init\n");
-        return;
-    }
-    
-    // Get or create function record for per-function tracking
-    FunctionRecord* func_record = get_function_record(func_name);
-    
-    // Increment the appropriate global counter
-    if (strcmp(counter_type, "COMP") == 0) {
-        global_count_config.countvariables.countcomp += amount;
-        if (func_record) func_record->counts.countcomp += amount;
-    } else if (strcmp(counter_type, "IO") == 0) {
-        global_count_config.countvariables.countio += amount;
-        if (func_record) func_record->counts.countio += amount;
-    } else if (strcmp(counter_type, "GEN") == 0) {
-        global_count_config.countvariables.countgen += amount;
-        if (func_record) func_record->counts.countgen += amount;
-    } else {
-        fprintf(stderr, "[COUNT ERROR] Unknown counter type: %s\n", counter_type);
-        return;
-    }
-    
-    // Format and output the count report
+void count_log(int slot, int amount, CounterType type) {
+    static const char* type_names[] = { "COMP", "IO", "GEN" };
+    const CountVars* partial = &count_state.functions[slot];
+    const CountVars* total = &global_count_config.countvariables;
     FILE* out = global_count_config.countifle ? global_count_config.countifle : stdout;
-    
+
     // Partial counts = per-function totals, Total counts = global cumulative
     fprintf(out, "[COUNT] line=%-4d func=%-30s +%-4d %-4s | partial: comp=%-6d io=%-6d gen=%-6d | total: comp=%-6d io=%-6d gen=%-6d\n",
-            line,
-            func_name,
+            status.line,
+            slot_name(slot),
             amount,
-            counter_type,
-            func_record ? func_record->counts.countcomp : 0,
-            func_record ? func_record->counts.countio : 0,
-            func_record ? func_record->counts.countgen : 0,
-            global_count_config.countvariables.countcomp,
-            global_count_config.countvariables.countio,
-            global_count_config.countvariables.countgen);
+            type_names[type],
+            partial->countcomp,
+            partial->countio,
+            partial->countgen,
+            total->countcomp,
+            total->countio,
+            total->countgen);
     
     fflush(out);
 }
 
+/**
+ * Appends the counts of this scan to a TSV file, one line per function and a TOTAL line:
+ *     <input>\t<function>\t<comp>\t<io>\t<gen>
+ * The counts do not depend on the machine, so tests/count_baseline compares them
+ * with a committed baseline
+ */
+static void count_write_tsv(const char* filename) {
+#ifndef _WIN32
+    pthread_mutex_lock(&functions_lock); // -batch: one scan at a time appends its lines
+#endif
+    FILE* tsv = fopen(filename, "a");
+    if (tsv == NULL) {
+        fprintf(stderr, "[COUNT ERROR] Could not open '%s' for the counts\n", filename);
+    } else {
+        for (int i = 0; i < count_state.num_used; i++) {
+            int slot = count_state.order[i];
+            const CountVars* counts = &count_state.functions[slot];
+            fprintf(tsv, "%s\t%s\t%d\t%d\t%d\n", status.ifile_name, slot_name(slot),
+                    counts->countcomp, counts->countio, counts->countgen);
+        }
+        const CountVars* total = &global_count_config.countvariables;
+        fprintf(tsv, "%s\tTOTAL\t%d\t%d\t%d\n", status.ifile_name,
+                total->countcomp, total->countio, total->countgen);
+        fclose(tsv);
+    }
+#ifndef _WIN32
+    pthread_mutex_unlock(&functions_lock);
+#endif
+}
+
+void count_chunk_begin(CountSaved* saved, bool counting) {
+    saved->state = count_state;
+    saved->total = global_count_config.countvariables;
+    memset(&count_state, 0, sizeof(count_state));
+    count_state.active = counting;   // Sense traça: les línies dels fils sortirien barrejades
+}
+
+void count_chunk_end(const CountSaved* saved, CountState* chunk) {
+    *chunk = count_state;
+    count_state = saved->state;
+    global_count_config.countvariables = saved->total; // El tros s'hi suma a count_merge
+}
+
+void count_merge(const CountState* chunk) {
+    if (!count_state.active) return;
+
+    for (int i = 0; i < chunk->num_used; i++) {
+        int slot = chunk->order[i];
+        const CountVars* counts = &chunk->functions[slot];
+        if (!count_state.used[slot]) {
+            count_first_use(slot);
+        }
+        count_vars_add(&count_state.functions[slot], COUNTER_COMP, counts->countcomp);
+        count_vars_add(&count_state.functions[slot], COUNTER_IO, counts->countio);
+        count_vars_add(&count_state.functions[slot], COUNTER_GEN, counts->countgen);
+        count_vars_add(&global_count_config.countvariables, COUNTER_COMP, counts->countcomp);
+        count_vars_add(&global_count_config.countvariables, COUNTER_IO, counts->countio);
+        count_vars_add(&global_count_config.countvariables, COUNTER_GEN, counts->countgen);
+    }
+}
+
 /**
  * Finalize the counting system and print summary
  */
 void count_finalize(void) {
     if (status.oform != DEBUG) return;
 
-    if (!count_initialized) {
+    if (!count_state.active) {
         fprintf(stderr, "[COUNT WARNING] count_finalize called but counting was not initialized\n");
         return;
     }
@@ -193,14 +245,15 @@ void count_finalize(void) {
     fprintf(out, "[COUNT] === Per-Function Statistics ===\n");
     
     // Report per-function counts
-    for (int i = 0; i < num_functions; i++) {
-        FunctionRecord* rec = &function_records[i];
-        int func_total = rec->counts.countcomp + rec->counts.countio + rec->counts.countgen;
+    for (int i = 0; i < count_state.num_used; i++) {
+        int slot = count_state.order[i];
+        const CountVars* counts = &count_state.functions[slot];
+        int func_total = counts->countcomp + counts->countio + counts->countgen;
         fprintf(out, "[COUNT] %-30s | comp=%-6d io=%-6d gen=%-6d | total=%-6d\n",
-                rec->name,
-                rec->counts.countcomp,
-                rec->counts.countio,
-                rec->counts.countgen,
+                slot_name(slot),
+                counts->countcomp,
+                counts->countio,
+                counts->countgen,
                 func_total);
     }
     
@@ -217,6 +270,10 @@ void count_finalize(void) {
     fprintf(out, "[COUNT] ==========================================\n");
     
     fflush(out);
+
+    if (status.count_tsv[0] != '\0') {
+        count_write_tsv(status.count_tsv);
+    }
     
     // Close the dbgcnt file if it was opened (and it's not stderr)
     if (global_count_config.countout == DBGCOUNT && 
@@ -227,9 +284,7 @@ void count_finalize(void) {
         fprintf(stderr, "[COUNT] Debug count file closed\n");
     }
     
-    // Reset state
-    count_initialized = false;
-    num_functions = 0;
-    memset(function_records, 0, sizeof(function_records));
+    // Reset state (the function slots stay registered for the next scan)
+    memset(&count_state, 0, sizeof(count_state));
     global_count_config.countifle = NULL;
 }
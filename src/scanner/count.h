@@ -16,6 +16,16 @@
  * - COUNT_GEN(n): Count general instructions
  * - COUNT_FINALIZE(): Finalize and output statistics
  *
+ * The counts are kept in memory and written at COUNT_FINALIZE (per function
+ * and global). Every call site keeps the slot of its function in a static
+ * variable, found once, so an increment is an add to an array (no string
+ * search nor output). With -countlog every increment is also written as a
+ * [COUNT] line (the old trace, much slower).
+ * A scan split over threads (-jobs) counts every chunk apart (count_chunk_begin
+ * / count_chunk_end, on the thread that scans it) and the main thread adds
+ * the chunk counts to its own (count_merge), so the summary has the work of
+ * every thread.
+ *
  * Team: GA
  * Contributor/s: Marc Rodríguez
  * -----------------------------------------------------------------------------
@@ -27,36 +37,110 @@
 #include "config.h"
 #include <stdbool.h>
 
+#define MAX_COUNT_FUNCTIONS 100    // Functions with their own counters (the rest share the last slot)
+
+typedef enum {
+    COUNTER_COMP,   // Comparisons
+    COUNTER_IO,     // Input/Output
+    COUNTER_GEN     // General instructions
+} CounterType;
+
+// Counters of one scan (per thread, like status)
+typedef struct CountState {
+    bool active;                                    // Between count_init and count_finalize (DEBUG)
+    bool log;                                       // -countlog: write every increment
+    CountVars functions[MAX_COUNT_FUNCTIONS + 1];   // Counts of each function slot
+    bool used[MAX_COUNT_FUNCTIONS + 1];             // Slot already counted in this scan
+    int order[MAX_COUNT_FUNCTIONS + 1];             // Slots in order of first use (summary order)
+    int num_used;
+} CountState;
+
 // External references
-extern CountConfig global_count_config;
-extern Status status;  // Needed for COUNT macros to access status.line and status.ifile_name
+extern _Thread_local CountConfig global_count_config;
+extern _Thread_local CountState count_state;
+extern _Thread_local Status status;  // Needed for COUNT macros to access status.line and status.ifile_name
 
 void count_init(const char* ifile_name, bool countout_flag);
-void count_increment(const char* func_name, int line, int amount, const char* counter_type);
+int count_register(const char* func_name);
+void count_first_use(int slot);
+void count_log(int slot, int amount, CounterType type);
 void count_finalize(void);
 
+// Counters of a thread set aside while it counts a -jobs chunk
+typedef struct CountSaved {
+    CountState state;
+    CountVars total;                                // global_count_config.countvariables
+} CountSaved;
+
+/**
+ * Counts of a part of the scan apart from the rest (a -jobs chunk): count_chunk_begin keeps the
+ * counters of this thread in saved and starts empty ones (active if counting, no -countlog
+ * trace); count_chunk_end moves the part's counts to chunk and puts the saved counters back
+ */
+void count_chunk_begin(CountSaved* saved, bool counting);
+void count_chunk_end(const CountSaved* saved, CountState* chunk);
+
+// Adds the counts of a chunk to the counters of this thread (functions in order of first use)
+void count_merge(const CountState* chunk);
+
+static inline void count_vars_add(CountVars* vars, CounterType type, int amount) {
+    switch (type) {
+        case COUNTER_COMP: vars->countcomp += amount; break;
+        case COUNTER_IO:   vars->countio += amount;   break;
+        case COUNTER_GEN:  vars->countgen += amount;  break;
+    }
+}
+
+/**
+ * Adds amount to the counter of the function of the call site
+ * @param slot Static slot of the call site (-1 until the function is registered)
+ */
+static inline void count_add(int* slot, const char* func_name, int amount, CounterType type) {
+    if (!count_state.active) return;
+    if (*slot < 0) {
+        *slot = count_register(func_name);
+    }
+    if (!count_state.used[*slot]) {
+        count_first_use(*slot);
+    }
+    count_vars_add(&count_state.functions[*slot], type, amount);
+    count_vars_add(&global_count_config.countvariables, type, amount);
+    if (count_state.log) {
+        count_log(*slot, amount, type);
+    }
+}
+
 // Preprocessor macros for conditional counting
-// When COUNTCONFIG_F is true, these expand to actual function calls
-// If the flag is false the functions are empty and do not add overhead
+// When COUNT_F is ON these add to the counters (only while counting, DEBUG outformat)
+// If the flag is OFF they expand to nothing and do not add overhead
+// (OUTFORMAT_M is an enum value, the preprocessor can not test it)
 
-#if OUTFORMAT_M == DEBUG
+#if COUNT_F == ON
 
     #define COUNT_INIT() count_init(status.ifile_name, COUNTOUT_F)
-    
+
     #define COUNT_FINALIZE() count_finalize()
-    
+
+    // Slot per call site and thread: registered the first time, then only an index
+    #define COUNT_ADD(n, type) do { \
+            static _Thread_local int count_slot = -1; \
+            count_add(&count_slot, __func__, (n), (type)); \
+        } while (0)
+
     //function to count comparisons
-    #define COUNT_COMP(n) count_increment(__func__, status.line, (n), "COMP")
-    
+    #define COUNT_COMP(n) COUNT_ADD((n), COUNTER_COMP)
+
     //function to count I/O operations
-    #define COUNT_IO(n) count_increment(__func__, status.line, (n), "IO")
-    
+    #define COUNT_IO(n) COUNT_ADD((n), COUNTER_IO)
+
     //function to count general instructions
-    #define COUNT_GEN(n) count_increment(__func__, status.line, (n), "GEN")
-    
-    //function to report a count increment with full context
-    #define COUNT_REPORT(func_name, amount, counter_type) \
-        count_increment((func_name), status.line, (amount), (counter_type))
+    #define COUNT_GEN(n) COUNT_ADD((n), COUNTER_GEN)
+
+    //function to report a count increment for another function name (looked up every time)
+    #define COUNT_REPORT(func_name, amount, counter_type) do { \
+            int count_slot = -1; \
+            count_add(&count_slot, (func_name), (amount), (counter_type)); \
+        } while (0)
 
 #else
     // When counting is disabled, all macros expand to nothing
@@ -67,6 +151,6 @@ void count_finalize(void);
     #define COUNT_GEN(n) ((void)0)
     #define COUNT_REPORT(func_name, amount, counter_type) ((void)0)
 
-#endif // OUTFORMAT_M == DEBUG
+#endif // COUNT_F == ON
 
 #endif // COUNT_H
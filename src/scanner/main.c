@@ -13,6 +13,8 @@
  * 4. Run automata driver to scan the input file and generate tokens
  * 5. Close files and finalize error reporting
  * 6. Exit with appropriate status code based on error count
+ * With -batch, steps 2-5 run for every input file on a pool of worker threads
+ * With -cache DIR, step 4 is a copy when the same input was scanned before
  *
  * Token Categories Recognized:
  * - Numbers (integers, floats)
@@ -26,6 +28,8 @@
  *
  * Usage:
  *     ./scanner <input_file> [-help]
+ *     ./scanner -batch <input_file> <input_file> ... [-jobs N]
+ *     ./scanner <input_file> -cache <directory>
  *     Output file: <input_file>scn
  *     Use -help flag for detailed usage information
  *
@@ -42,31 +46,35 @@
 #include "config.h"
 #include "count.h"
 #include "module_init/module_init.h"
+#include "module_batch/module_batch.h"
+#include "module_cache/module_cache.h"
 
-int main(int argc, char *argv[]) {
-    error_init();
-    
-    // Initialize operation counting system
-    
-    int returned = init_program(argc, argv);
-    
+/**
+ * Escaneja el fitxer obert per init_file_scn i tanca'l (passos 3-5)
+ * @return Nombre d'errors del fitxer
+ */
+static int scan_file(void) {
+    // -cache: the same bytes were scanned before, their tokens are copied instead
+    bool caching = status.cache_dir[0] != '\0';
+    uint64_t key = caching ? cache_key() : 0;
+    bool cached = caching && cache_lookup(key);
+    long tokens_from = ftell(status.ofile);
+    long tokens_to = tokens_from;
 
-    if (returned == HELP_RETURN) {
-        return 0;
-    }
+    if (!cached) {
+        // Initialize automata for token recognition
+        AutomataList automata_list;
+        init_automata(&automata_list);
 
-    if (returned != CORRECT_RETURN) {
-        report_error_typed(ERR_INVALID_ARGUMENT, 0, SCANNER_STEP);
-        error_finalize();
-        return 1;
-    }
-
-    // Initialize automata for token recognition
-    AutomataList automata_list;
-    init_automata(&automata_list);
+        // Run automata driver to scan input and generate tokens
+        automata_driver(&automata_list);
+        tokens_to = ftell(status.ofile);
 
-    // Run automata driver to scan input and generate tokens
-    automata_driver(automata_list.automatas, automata_list.num_automata);
+        // Binary token file for the parser (optional, the text output is always written)
+        if (status.binary_out) {
+            write_tokens_binary(status.bfile_name);
+        }
+    }
 
     // Finalize errors BEFORE closing files (error_finalize may write to ofile in debug mode)
     error_finalize();
@@ -84,6 +92,60 @@ int main(int argc, char *argv[]) {
         status.ofile = NULL;
     }
 
+    // Only clean scans: the messages of errors and warnings are not in the cached tokens
+    if (caching && !cached && error_count() == 0 && warning_count() == 0 && !status.count_log) {
+        cache_store(key, tokens_from, tokens_to);
+    }
+    free_token_list(&status.all_tokens);
+    free_symbol_table(&status.symbols);
+    free(status.lines.newlines);
+    memset(&status.lines, 0, sizeof(status.lines));
+    free(status.input);
+    status.input = NULL;
+
+    return error_count();
+}
+
+// Un fitxer de -batch, al fil del worker (status, errors i comptatge són d'aquest fil)
+static int scan_batch_file(const char* ifile_name, const Status* options) {
+    status = *options;
+    error_init();
+    if (init_file_scn(ifile_name) != CORRECT_RETURN) {
+        error_free();   // No s'ha escanejat (sense error_finalize): els missatges no es queden al fil
+        return error_count() > 0 ? error_count() : 1;
+    }
+    return scan_file();
+}
+
+int main(int argc, char *argv[]) {
+    error_init();
+    
+    // Initialize operation counting system
+    
+    int returned = init_program(argc, argv);
+    
+
+    if (returned == HELP_RETURN) {
+        free(status.batch_files);
+        return 0;
+    }
+
+    if (returned == BATCH_RETURN) {
+        Status options = status;    // Flags for every file (copy: each worker writes its own status)
+        options.jobs = 0;           // -jobs is the number of workers, each file is scanned by one
+        options.error_file = stderr;
+        int errors = scan_batch(options.batch_files, options.num_batch_files, status.jobs, &options, scan_batch_file);
+        free(status.batch_files);
+        return (errors > 0) ? 1 : 0;
+    }
+    free(status.batch_files);
+    status.batch_files = NULL;
+
+    if (returned != CORRECT_RETURN) {
+        report_error_typed(ERR_INVALID_ARGUMENT, 0, SCANNER_STEP);
+        error_finalize();
+        return 1;
+    }
 
-    return (error_count() > 0) ? 1 : 0;
+    return (scan_file() > 0) ? 1 : 0;
 }
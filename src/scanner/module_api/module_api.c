@@ -0,0 +1,104 @@
+/*
+ * -----------------------------------------------------------------------------
+ * module_api.c
+ *
+ * Pull API of the Scanner (see module_api.h): scanner_next is one scan_token
+ * over the scanner's own copy of the input, with the AutomataList of the
+ * scanner (engine and cursors). The line index is built when it is opened, as
+ * automata_driver does, and the line of every token is searched forward from
+ * the one of the previous token. Identifiers, keywords, types and literals
+ * are interned in the scanner's own symbol table.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include "module_api.h"
+#include "../count.h"
+#include "../module_automata/module_automata.h"
+#include <stdint.h>
+#include <string.h>
+
+// The SIMD kernels read whole aligned blocks (AVX2: 32 bytes): the copy starts at a block
+// and its last block is allocated too, so they never read outside of it
+#define INPUT_BLOCK 32
+
+struct Scanner {
+    char* memory;           // Allocation of the copy
+    char* input;            // Copy of the buffer, NUL-terminated, at the start of a block
+    int len;
+    int idx;                // Position right after the last token
+    int newlines;           // '\n' before the last token (its line - 1)
+    ColumnCursor column;    // Column of the last token
+    LineIndex lines;
+    SymbolTable symbols;
+    AutomataList automata;
+};
+
+Scanner* scanner_open(const char* buffer, int len, Engine engine) {
+    Scanner* scanner = calloc(1, sizeof(Scanner));
+    COUNT_COMP(1);
+    if (!scanner) {
+        return NULL;
+    }
+    size_t blocks = ((size_t)len + 1 + INPUT_BLOCK - 1) / INPUT_BLOCK;
+    scanner->memory = malloc((blocks + 1) * INPUT_BLOCK);
+    COUNT_COMP(1);
+    if (!scanner->memory) {
+        free(scanner);
+        return NULL;
+    }
+    scanner->input = scanner->memory + (INPUT_BLOCK - (uintptr_t)scanner->memory % INPUT_BLOCK) % INPUT_BLOCK;
+    memcpy(scanner->input, buffer, (size_t)len);
+    scanner->input[len] = '\0';
+    scanner->len = len;
+
+    COUNT_COMP(1);
+    if (!build_line_index(&scanner->lines, scanner->input, len)) {  // També l'UTF-8: columnes en caràcters
+        scanner_close(scanner);
+        return NULL;
+    }
+
+    init_automata_list(&scanner->automata, engine);  // Aquest escaneig, no el de status
+    COUNT_GEN(5);
+    return scanner;
+}
+
+bool scanner_next(Scanner* scanner, ScannerToken* token) {
+    Token scanned = scan_token(scanner->input, scanner->len, &scanner->idx, &scanner->automata);
+    COUNT_COMP(1);
+    if (scanned.len == 0) {  // No queden tokens
+        return false;
+    }
+
+    scanner->newlines = line_index_seek(&scanner->lines, scanner->newlines, scanned.offset);
+    token->lexeme = scanner->input + scanned.offset;
+    token->len = scanned.len;
+    token->offset = scanned.offset;
+    token->line = scanner->newlines + 1;
+    token->column = column_cursor_seek(&scanner->column, &scanner->lines, scanner->input, scanner->newlines, scanned.offset);
+    token->cat = scanned.cat;
+    token->error = scanned.error;
+    COUNT_COMP(1);
+    token->symbol = is_symbol_category(scanned.cat)
+                  ? symbol_table_intern(&scanner->symbols, scanner->input, scanned.offset, scanned.len)
+                  : NO_SYMBOL;
+    COUNT_GEN(9);
+    return true;
+}
+
+int scanner_num_symbols(const Scanner* scanner) {
+    return scanner->symbols.count;
+}
+
+void scanner_close(Scanner* scanner) {
+    COUNT_COMP(1);
+    if (!scanner) {
+        return;
+    }
+    free(scanner->lines.newlines);
+    free_symbol_table(&scanner->symbols);
+    free(scanner->memory);
+    free(scanner);
+}
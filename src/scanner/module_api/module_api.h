@@ -0,0 +1,108 @@
+/*
+ * -----------------------------------------------------------------------------
+ * module_api.h
+ *
+ * Pull API of the Scanner, for programs that want the tokens of a buffer
+ * without running the scanner executable and reading its .cscn:
+ *
+ *     Scanner *scanner = scanner_open(buffer, len, ENGINE_COMBINED);
+ *     ScannerToken tok;
+ *     while (scanner_next(scanner, &tok)) {
+ *         ... tok.lexeme (tok.len bytes), tok.cat, tok.line, tok.column ...
+ *     }
+ *     scanner_close(scanner);
+ *
+ * All the state of a scan is in the Scanner (a copy of the input, its line
+ * index, its symbol table and the automata cursors): nothing is read from or
+ * written to status, no file is opened and no error is reported, so several
+ * scanners can be open at the same time (also in different threads). A token that is not recognized
+ * comes as CAT_NONRECOGNIZED with tok.error saying why, as in the .cscn.
+ *
+ * For a text that is being edited (an editor, a language server) a
+ * TokenStream keeps the tokens of the whole text and token_stream_edit
+ * applies byte-range edits to it: only the tokens around each edit are
+ * scanned again (scan_incremental.c), the rest are moved.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef MODULE_API_H
+#define MODULE_API_H
+
+#include <stdbool.h>
+#include "../config.h"
+
+typedef struct ScannerToken {
+    const char* lexeme;     // Start of the lexeme in the scanner's copy of the input (len bytes, not NUL-terminated)
+    int len;
+    int offset;             // Byte offset in the input
+    int line;               // From 1
+    int column;             // From 1, in characters (UTF-8)
+    Category cat;
+    Error error;            // ERR_NONE, or why a CAT_NONRECOGNIZED token was cut (e.g. unterminated literal)
+    int symbol;             // Same lexeme = same ID in this scanner (identifiers, keywords, types and
+                            // literals), NO_SYMBOL for the other categories
+} ScannerToken;
+
+typedef struct Scanner Scanner;
+
+/**
+ * Starts a scan of buffer[0 .. len) (copied: the buffer can be freed after the call).
+ * As in the scanner, the input ends at len: a '\0' in it is a CAT_NONRECOGNIZED token (ERR_NUL_BYTE).
+ * Returns NULL if out of memory.
+ */
+Scanner* scanner_open(const char* buffer, int len, Engine engine);
+
+// Next token of the input; false (and nothing written in token) when there are no more
+bool scanner_next(Scanner* scanner, ScannerToken* token);
+
+// Number of different symbols (IDs 0 .. count - 1) of the tokens returned until now
+int scanner_num_symbols(const Scanner* scanner);
+
+// Frees the scanner; the lexemes of its tokens are not valid anymore
+void scanner_close(Scanner* scanner);
+
+// Replaces text[offset .. offset + removed) with text[0 .. inserted)
+typedef struct ScanEdit {
+    int offset;             // In the text as it is before this edit (after the previous ones)
+    int removed;
+    const char* text;
+    int inserted;
+} ScanEdit;
+
+typedef struct TokenStream TokenStream;
+
+/**
+ * Scans the whole buffer[0 .. len) (copied) and keeps its tokens.
+ * Returns NULL if out of memory.
+ */
+TokenStream* token_stream_open(const char* buffer, int len, Engine engine);
+
+/**
+ * Applies the edits in order and updates the tokens: the scan starts again at the first
+ * token that read a byte at or after the edit and stops as soon as a token ends where an
+ * old one ended after the edit; the tokens after it are kept with their offsets moved.
+ * Returns the number of tokens scanned again, -1 if an edit is out of the text (that edit
+ * and the next ones are not applied) or if out of memory (the text has
+ * the edit, the tokens are scanned again by the next call, also with num_edits 0).
+ */
+int token_stream_edit(TokenStream* stream, const ScanEdit* edits, int num_edits);
+
+// Current text (len bytes, NUL-terminated)
+const char* token_stream_text(const TokenStream* stream, int* len);
+
+int token_stream_count(const TokenStream* stream);
+
+/**
+ * Token k (from 0) of the current text, as scanner_next would return it, but with
+ * symbol NO_SYMBOL: the lexemes move with the edits (intern them with a Scanner if needed).
+ * false if there is no token k. The lexeme is valid until the next edit.
+ * Getting the tokens in order reads each byte of the text once to find the columns.
+ */
+bool token_stream_get(TokenStream* stream, int k, ScannerToken* token);
+
+void token_stream_close(TokenStream* stream);
+
+#endif
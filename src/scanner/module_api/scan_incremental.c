@@ -0,0 +1,344 @@
+/*
+ * -----------------------------------------------------------------------------
+ * scan_incremental.c
+ *
+ * Incremental scan of a text that is being edited (TokenStream, see
+ * module_api.h). An edit replaces a byte range of the text:
+ * - The tokens before the edit are kept if they did not read any byte of it:
+ *   every token has its reach (scan_token, right after the last byte read,
+ *   lookahead and the bytes after a longest-match backtrack included), and
+ *   the stream keeps the greatest reach up to each token, so the first token
+ *   to scan again is a binary search.
+ * - The scan starts where the token before it ended and goes on until a new
+ *   token ends where an old token ended after the edit (moved by the size of
+ *   the edit): scan_token only depends on the position and the bytes after
+ *   it, so from there the old tokens are the same, with offsets moved. This is
+ *   the resync of the chunks of scan_parallel.c.
+ * - The '\n' offsets inside the edit are replaced and the ones after it are
+ *   moved, so lines and columns are still found from the offsets.
+ * So the tokens scanned are the ones around the edit; the text and the tokens
+ * after it are moved with one memmove and the offsets with one add each.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include "module_api.h"
+#include "../count.h"
+#include "../module_automata/module_automata.h"
+#include <stdint.h>
+#include <string.h>
+
+#define INPUT_BLOCK 32          // As in module_api.c: the SIMD kernels read whole aligned blocks
+#define MIN_STREAM_TOKENS 1024
+
+struct TokenStream {
+    char* memory;           // Allocation of the text
+    char* input;            // Text (len bytes, '\0' after them), at the start of a block
+    int len;
+    size_t size;            // Bytes of memory
+    Token* tokens;          // reach = greatest reach of this token and the ones before it
+    int count;
+    int capacity;
+    Token* fresh;           // Tokens of the current rescan, before they replace the old ones
+    int fresh_count;
+    int fresh_capacity;
+    bool complete;          // false after running out of memory in a rescan: the next one scans it all
+    LineIndex lines;
+    ColumnCursor column;    // Column of the last token got: in order, each one reads only its own line
+    AutomataList automata;
+};
+
+// Room for a text of len bytes (and its '\0', in whole blocks); the text is kept
+static bool reserve_text(TokenStream* stream, int len) {
+    size_t blocks = ((size_t)len + 1 + INPUT_BLOCK - 1) / INPUT_BLOCK;
+    size_t size = (blocks + 1) * INPUT_BLOCK;
+    COUNT_COMP(1);
+    if (size <= stream->size) {
+        return true;
+    }
+    if (size < 2 * stream->size) {  // Creix al doble: una tecla rere l'altra no copia cada cop
+        size = 2 * stream->size;
+    }
+    char* memory = malloc(size);
+    if (!memory) {
+        return false;
+    }
+    char* input = memory + (INPUT_BLOCK - (uintptr_t)memory % INPUT_BLOCK) % INPUT_BLOCK;
+    if (stream->memory) {
+        memcpy(input, stream->input, (size_t)stream->len + 1);
+        free(stream->memory);
+    }
+    stream->memory = memory;
+    stream->input = input;
+    stream->size = size;
+    return true;
+}
+
+static bool reserve_tokens(Token** tokens, int* capacity, int count) {
+    COUNT_COMP(1);
+    if (count <= *capacity) {
+        return true;
+    }
+    int grown = *capacity ? *capacity * 2 : MIN_STREAM_TOKENS;
+    while (grown < count) {
+        grown *= 2;
+    }
+    Token* more = realloc(*tokens, grown * sizeof(Token));
+    if (!more) {
+        return false;
+    }
+    *tokens = more;
+    *capacity = grown;
+    return true;
+}
+
+static bool reserve_lines(LineIndex* lines, int count) {
+    COUNT_COMP(1);
+    if (count <= lines->capacity) {
+        return true;
+    }
+    int grown = lines->capacity ? lines->capacity * 2 : MIN_STREAM_TOKENS;
+    while (grown < count) {
+        grown *= 2;
+    }
+    int* more = realloc(lines->newlines, grown * sizeof(int));
+    if (!more) {
+        return false;
+    }
+    lines->newlines = more;
+    lines->capacity = grown;
+    return true;
+}
+
+// Position where the scan of old token k started (right after the token before it)
+static int scan_start(const TokenStream* stream, int k) {
+    return k == 0 ? 0 : stream->tokens[k - 1].offset + stream->tokens[k - 1].len;
+}
+
+// First token that read a byte at or after offset (count if none)
+static int first_affected(const TokenStream* stream, int offset) {
+    int low = 0;
+    int high = stream->count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (stream->tokens[mid].reach <= offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+        COUNT_COMP(1);
+    }
+    return low;
+}
+
+/**
+ * Scans the text again from the end of old token first - 1 and replaces old tokens
+ * [first .. resync) with the new ones. The old tokens that started their scan at or
+ * after edit_end (old offsets) can be reused, moved by delta; none if the stream is not
+ * complete. Returns the number of tokens scanned, -1 if out of memory.
+ */
+static int rescan(TokenStream* stream, int first, int edit_end, int delta) {
+    int idx = scan_start(stream, first);
+    int old = first;            // Next old token whose scan start can match idx
+    stream->fresh_count = 0;
+    while (true) {
+        Token token = scan_token(stream->input, stream->len, &idx, &stream->automata);
+        COUNT_COMP(1);
+        if (token.len == 0) {   // Final del text: cap token vell no es torna a fer servir
+            old = stream->count;
+            break;
+        }
+        if (!reserve_tokens(&stream->fresh, &stream->fresh_capacity, stream->fresh_count + 1)) {
+            stream->count = 0;
+            stream->complete = false;
+            return -1;
+        }
+        stream->fresh[stream->fresh_count++] = token;
+
+        if (!stream->complete) {
+            continue;
+        }
+        while (old <= stream->count && (scan_start(stream, old) < edit_end || scan_start(stream, old) + delta < idx)) {
+            old++;
+            COUNT_COMP(2);
+        }
+        COUNT_COMP(2);
+        if (old <= stream->count && scan_start(stream, old) + delta == idx) { // Resincronitzat
+            break;
+        }
+    }
+
+    int fresh = stream->fresh_count;
+    int tail = stream->count - old;
+    if (!reserve_tokens(&stream->tokens, &stream->capacity, first + fresh + tail)) {
+        stream->count = 0;
+        stream->complete = false;
+        return -1;
+    }
+    memmove(stream->tokens + first + fresh, stream->tokens + old, tail * sizeof(Token));
+    memcpy(stream->tokens + first, stream->fresh, fresh * sizeof(Token));
+    stream->count = first + fresh + tail;
+
+    int reach = first > 0 ? stream->tokens[first - 1].reach : 0;
+    for (int k = first; k < first + fresh; k++) {
+        reach = stream->tokens[k].reach > reach ? stream->tokens[k].reach : reach;
+        stream->tokens[k].reach = reach;
+        COUNT_COMP(1);
+    }
+    for (int k = first + fresh; k < stream->count; k++) { // Tokens vells: només es mouen
+        stream->tokens[k].offset += delta;
+        int moved = stream->tokens[k].reach + delta;
+        reach = moved > reach ? moved : reach;
+        stream->tokens[k].reach = reach;
+        COUNT_COMP(1);
+        COUNT_GEN(2);
+    }
+    stream->complete = true;
+    return fresh;
+}
+
+// Replaces the '\n' offsets of the edited range and moves the ones after it
+static void edit_lines(LineIndex* lines, const ScanEdit* edit, int added) {
+    int first = line_index_seek(lines, 0, edit->offset);
+    int last = line_index_seek(lines, first, edit->offset + edit->removed);
+    int delta = edit->inserted - edit->removed;
+    int tail = lines->count - last;
+    memmove(lines->newlines + first + added, lines->newlines + last, tail * sizeof(int));
+    for (int k = first + added; k < first + added + tail; k++) {
+        lines->newlines[k] += delta;
+    }
+    COUNT_GEN(tail);
+    int k = first;
+    for (int i = 0; i < edit->inserted; i++) {
+        COUNT_COMP(2);
+        if (edit->text[i] == END_OF_LINE) {
+            lines->newlines[k++] = edit->offset + i;
+        }
+        if ((unsigned char)edit->text[i] >= 0x80) { // Columnes en caràcters a partir d'ara
+            lines->ascii = false;
+        }
+    }
+    lines->count = first + added + tail;
+}
+
+// Applies one edit; returns the number of tokens scanned again, -1 if not valid or out of memory
+static int apply_edit(TokenStream* stream, const ScanEdit* edit) {
+    COUNT_COMP(4);
+    if (edit->offset < 0 || edit->removed < 0 || edit->inserted < 0 || edit->offset > stream->len
+        || edit->removed > stream->len - edit->offset || (edit->inserted > 0 && !edit->text)) {
+        return -1;
+    }
+    int added = 0;
+    for (int i = 0; i < edit->inserted; i++) {
+        added += edit->text[i] == END_OF_LINE;
+    }
+    COUNT_GEN(edit->inserted);
+    int len = stream->len - edit->removed + edit->inserted;
+    if (!reserve_text(stream, len) || !reserve_lines(&stream->lines, stream->lines.count + added)) {
+        return -1;
+    }
+
+    // Primer token a tornar a escanejar, amb les posicions d'abans de l'edició
+    int first = stream->complete ? first_affected(stream, edit->offset) : 0;
+    int edit_end = edit->offset + edit->removed;
+    int delta = edit->inserted - edit->removed;
+
+    memmove(stream->input + edit->offset + edit->inserted, stream->input + edit_end,
+            (size_t)(stream->len - edit_end) + 1);  // '\0' inclòs
+    if (edit->inserted > 0) {
+        memcpy(stream->input + edit->offset, edit->text, (size_t)edit->inserted);
+    }
+    stream->len = len;
+    edit_lines(&stream->lines, edit, added);
+    stream->column = (ColumnCursor){0};    // Els caràcters d'abans del cursor poden haver canviat
+
+    return rescan(stream, first, edit_end, delta);
+}
+
+TokenStream* token_stream_open(const char* buffer, int len, Engine engine) {
+    TokenStream* stream = calloc(1, sizeof(TokenStream));
+    COUNT_COMP(1);
+    if (!stream) {
+        return NULL;
+    }
+    COUNT_COMP(1);
+    if (!reserve_text(stream, len)) {
+        token_stream_close(stream);
+        return NULL;
+    }
+    memcpy(stream->input, buffer, (size_t)len);
+    stream->input[len] = '\0';
+    stream->len = len;
+    COUNT_COMP(1);
+    if (!build_line_index(&stream->lines, stream->input, len)) {
+        token_stream_close(stream);
+        return NULL;
+    }
+
+    init_automata_list(&stream->automata, engine);
+    COUNT_COMP(1);
+    if (rescan(stream, 0, 0, 0) < 0) {
+        token_stream_close(stream);
+        return NULL;
+    }
+    return stream;
+}
+
+int token_stream_edit(TokenStream* stream, const ScanEdit* edits, int num_edits) {
+    int scanned = 0;
+    COUNT_COMP(1);
+    if (!stream->complete && num_edits == 0) {
+        return rescan(stream, 0, 0, 0);
+    }
+    for (int e = 0; e < num_edits; e++) {
+        int n = apply_edit(stream, &edits[e]);
+        COUNT_COMP(1);
+        if (n < 0) {
+            return -1;
+        }
+        scanned += n;
+    }
+    return scanned;
+}
+
+const char* token_stream_text(const TokenStream* stream, int* len) {
+    *len = stream->len;
+    return stream->input;
+}
+
+int token_stream_count(const TokenStream* stream) {
+    return stream->count;
+}
+
+bool token_stream_get(TokenStream* stream, int k, ScannerToken* token) {
+    COUNT_COMP(2);
+    if (k < 0 || k >= stream->count) {
+        return false;
+    }
+    const Token* scanned = &stream->tokens[k];
+    token->lexeme = stream->input + scanned->offset;
+    token->len = scanned->len;
+    token->offset = scanned->offset;
+    int newlines = line_index_seek(&stream->lines, 0, scanned->offset);
+    token->line = newlines + 1;
+    token->column = column_cursor_seek(&stream->column, &stream->lines, stream->input, newlines, scanned->offset);
+    token->cat = scanned->cat;
+    token->error = scanned->error;
+    token->symbol = NO_SYMBOL;
+    COUNT_GEN(8);
+    return true;
+}
+
+void token_stream_close(TokenStream* stream) {
+    COUNT_COMP(1);
+    if (!stream) {
+        return;
+    }
+    free(stream->lines.newlines);
+    free(stream->tokens);
+    free(stream->fresh);
+    free(stream->memory);
+    free(stream);
+}
@@ -6,12 +6,25 @@
  * Provides interfaces for automata execution and token recognition.
  *
  * Main Functions:
+ * - init_automata_list(): Automata of the tables, ready to scan with an engine
  * - write_token_to_file_and_list(): Output and record recognized tokens
- * - search_column(): Find alphabet symbol column mapping
- * - search_two_columns(): Map current and lookahead characters
- * - is_accepting_state(): Check acceptance state condition
- * - restart_automatas(): Reset automata to initial state
- * - automata_driver(): Execute scanning over input file
+ * - automata_transition(): Read one cell of the compact transition table
+ * - is_accepting_state(): Check acceptance state condition (bitset)
+ * - restart_automatas(): Reset the automata that can start with a byte
+ * - classify_identifier(): Perfect hash lookup of keywords and types
+ * - scan_token(): Recognize the next token of an in-memory buffer
+ * - automata_driver(): Execute scanning over input file (loop over scan_token)
+ * - scan_parallel(): Same scan split in chunks scanned by several threads (-jobs)
+ * - vector_token(): All the automata stepped at once in vector lanes (-vector)
+ * - skip_blanks(), find_run_end(): SIMD kernels for blanks and literal bodies
+ * - build_line_index(): SIMD pass that collects the '\n' offsets (lines on demand)
+ *   and validates the UTF-8 of the non-ASCII blocks
+ *
+ * The tables (ALL_AUTOMATA, COMBINED_AUTOMATA) are generated at build time
+ * from tokens.spec by scanner_tablegen (scanner_tables.c in the build tree).
+ * scan_token and what it calls (scan_token.c, scan_simd.c, scan_vector.c,
+ * scan_index.c and the tables) do not use status: they are also built as
+ * scanner_core, the library module_api links.
  *
  * Team: GA
  * Contributor/s: Pol García, Clara Serra, Jan Prats, Andrea Salló, Gorka Hernández, Marc Rodríguez
@@ -28,20 +41,86 @@
 
 
 
-int write_token_to_file_and_list(BufferAuto *buffer, Category cat);
+// Next state from the row-major transition table (0 = dead state)
+static inline int automata_transition(const AutomataDFA *a, int state, int column){
+    return a->transitions[state * a->width + column];
+}
+
+// Automata of the tables with their cursors at the start state; engine picks how scan_token steps them
+void init_automata_list(AutomataList* automata_list, Engine engine);
+
+// Writes the token (lexeme read from status.input) and appends it to status.all_tokens
+int write_token_to_file_and_list(const Token *token);
+
+bool is_accepting_state(const AutomataDFA *a, int state);
+
+// Starts a token: only the automata of list->first_byte[first] are active, back to the start state
+void restart_automatas(AutomataList *list, char first);
+
+// Hash of the reserved words table; must match reserved_hash() in tablegen.c
+static inline uint32_t reserved_hash(uint32_t seed, const char *s, int len){
+    uint32_t h = seed;
+    for (int i = 0; i < len; i++){
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+// CAT_KEYWORD / CAT_TYPE if the identifier is a reserved word, CAT_IDENTIFIER otherwise
+Category classify_identifier(const char *lexeme, int len);
+
+/**
+ * Single token scan: runs the automata (combined DFA, lockstep or vector, automata_list->engine) on the
+ * input[0 .. len) (with a '\0' at input[len]) starting at input[*idx], after skipping blanks.
+ * Returns the recognized token (offset/len into input, no copy) and advances *idx past
+ * consumed characters; a rejected lexeme is returned as CAT_NONRECOGNIZED, and len 0
+ * means end of input. A '\0' before len ends the token before it and is a CAT_NONRECOGNIZED
+ * token of its own (ERR_NUL_BYTE).
+ * automata_list holds the engine and the cursors of this scan (lockstep engine); nothing is read
+ * from status and the tables are read only, so several scans can run at the same time, each one
+ * with its own AutomataList.
+ */
+Token scan_token(const char* input, int len, int* idx, AutomataList* automata_list);
 
-int search_column(AutomataDFA *a, char actual_character);
+// Writes the token to the output (line breaks as automata_driver) and to the token list
+void output_token(const Token *token);
 
-Two_ints search_two_columns(AutomataDFA *a, char actual_character, char lookahead);
+/**
+ * Driver: loop over scan_token on status.input
+ * Escriu els tokens al fitxer de sortida i a la llista de tokens
+ */
+void automata_driver(AutomataList *automata_list);
 
-bool is_accepting_state(AutomataDFA *a, int state);
+/**
+ * Vectorized kernels (scan_simd.c: AVX2 / SSE2 / scalar)
+ * skip_blanks: first position from i that is not a blank
+ * find_run_end: first position from i holding one of the stop bytes or '\0', or limit if it comes first
+ * build_line_index: fills index with the offsets of the '\n' of input[0 .. len), sets index->ascii
+ *   and counts the invalid UTF-8 bytes, in the same pass; false if out of memory
+ * utf8_char_len: bytes of the UTF-8 character at p (NUL-terminated), 1 if it is not valid
+ */
+int skip_blanks(const char *input, int i);
+int find_run_end(const char *input, int i, int limit, const uint8_t *stops, int num_stops);
+bool build_line_index(LineIndex *index, const char *input, int len);
+int utf8_char_len(const char *p);
 
-void restart_automatas(AutomataDFA **a, int num_automata);
+/**
+ * Vector engine (scan_vector.c: AVX2 / scalar): steps every automaton of VECTOR_AUTOMATA
+ * at once from input[*idx] until the token ends, and advances *idx past it.
+ * Returns the same as the lockstep engine (Category, COMBINED_REJECT), or
+ * COMBINED_CONTINUE if the token reaches limit still open. While the token goes on,
+ * *prefix_end / *prefix_cat are set to the end and category of every accepted prefix.
+ */
+int vector_token(const char *input, int *idx, int limit, int *prefix_end, int *prefix_cat);
 
 /**
- * Driver que processa un fitxer amb múltiples autòmata DFA
- * Escriu tokens reconeguts i no reconeguts en fitxers separats
+ * Parallel driver (scan_parallel.c): splits status.input at newlines, scans the chunks
+ * on num_jobs threads (each one with a copy of automata_list) and writes the tokens in order.
+ * No token holds a newline, so chunks start between tokens; one that does not (the
+ * previous chunk ran out of memory) is rescanned from the end of the previous token,
+ * so the output is the same as automata_driver.
+ * Returns false (nothing done) if the input is too small to split or there are no threads.
  */
-void automata_driver(AutomataDFA **automata_list, int num_automata);
+bool scan_parallel(AutomataList *automata_list, int num_jobs);
 
  #endif
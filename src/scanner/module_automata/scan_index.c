@@ -0,0 +1,183 @@
+/*
+ * -----------------------------------------------------------------------------
+ * scan_index.c
+ *
+ * Indexes of a scanned input, kept by whoever owns the input (status for the
+ * scanner, the Scanner / TokenStream of module_api):
+ * - Symbol table: identifiers, keywords, types and literals interned by lexeme
+ * - Line / column of an input offset (binary search in the newline index that
+ *   build_line_index fills, and a cursor for the tokens pulled in order)
+ *
+ * Nothing here reads status or writes output, so module_api can link it
+ * without the rest of the scanner (scanner_core, see CMakeLists.txt).
+ *
+ * Team: GA
+ * Contributor/s: Pol García, Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include "../config.h"
+#include "../count.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// FNV-1a of the lexeme
+static uint32_t symbol_hash(const char* lexeme, int len) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)lexeme[i]) * 16777619u;
+    }
+    COUNT_GEN(len);
+    return h;
+}
+
+// Twice the slots (at most half of them full), placed again with the stored hashes
+static bool grow_symbol_slots(SymbolTable* table) {
+    int num_slots = table->num_slots ? table->num_slots * 2 : 1024;
+    int* slots = calloc(num_slots, sizeof(int));
+    if (!slots) {
+        return false;
+    }
+    for (int id = 0; id < table->count; id++) {
+        int s = (int)(table->hash[id] & (uint32_t)(num_slots - 1));
+        while (slots[s] != 0) {
+            s = (s + 1) & (num_slots - 1);
+        }
+        slots[s] = id + 1;
+    }
+    COUNT_GEN(2 * table->count);
+    free(table->slots);
+    table->slots = slots;
+    table->num_slots = num_slots;
+    return true;
+}
+
+/**
+ * Symbol ID of input[offset .. offset + len): the one of an earlier equal lexeme, or a new one
+ * (the lexeme is not copied, the table keeps its offset in input)
+ * Returns NO_SYMBOL if out of memory
+ */
+int symbol_table_intern(SymbolTable* table, const char* input, int offset, int len) {
+    uint32_t h = symbol_hash(input + offset, len);
+    COUNT_COMP(1);
+    if (2 * (table->count + 1) > table->num_slots && !grow_symbol_slots(table)) {
+        return NO_SYMBOL;
+    }
+    int mask = table->num_slots - 1;
+    int s = (int)(h & (uint32_t)mask);
+    while (table->slots[s] != 0) { // Sondeig lineal fins a un buit o el mateix lexema
+        int id = table->slots[s] - 1;
+        COUNT_COMP(2);
+        if (table->hash[id] == h && table->len[id] == len
+                && memcmp(input + table->offset[id], input + offset, len) == 0) {
+            return id;
+        }
+        s = (s + 1) & mask;
+    }
+
+    COUNT_COMP(1);
+    if (table->count == table->capacity) {
+        int capacity = table->capacity ? table->capacity * 2 : 512;
+        int* offsets = realloc(table->offset, capacity * sizeof(int));
+        if (offsets) table->offset = offsets;
+        int* lens = realloc(table->len, capacity * sizeof(int));
+        if (lens) table->len = lens;
+        uint32_t* hashes = realloc(table->hash, capacity * sizeof(uint32_t));
+        if (hashes) table->hash = hashes;
+        COUNT_GEN(3);
+        if (!offsets || !lens || !hashes) {
+            return NO_SYMBOL;
+        }
+        table->capacity = capacity;
+    }
+    int id = table->count++;
+    table->offset[id] = offset;
+    table->len[id] = len;
+    table->hash[id] = h;
+    table->slots[s] = id + 1;
+    COUNT_GEN(5);
+    return id;
+}
+
+void free_symbol_table(SymbolTable* table) {
+    free(table->offset);
+    free(table->len);
+    free(table->hash);
+    free(table->slots);
+    memset(table, 0, sizeof(*table));
+}
+
+/**
+ * Number of '\n' of the index before offset, searched from index->newlines[from]
+ * (binary search; from lets a caller going forward skip what it already passed)
+ */
+int line_index_seek(const LineIndex* index, int from, int offset) {
+    int low = from;
+    int high = index->count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (index->newlines[mid] < offset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+        COUNT_COMP(1);
+    }
+    COUNT_GEN(2);
+    return low;
+}
+
+// Line (from 1) of the character at offset
+int line_of_offset(const LineIndex* index, int offset) {
+    return line_index_seek(index, 0, offset) + 1;
+}
+
+/**
+ * Column (from 1) of the character at offset
+ * With non-ASCII input (index->ascii false) a column is a UTF-8 character: the
+ * continuation bytes (10xxxxxx) of the line before offset are not counted
+ */
+int column_of_offset(const LineIndex* index, const char* input, int offset) {
+    int newlines = line_index_seek(index, 0, offset);
+    int line_start = newlines == 0 ? 0 : index->newlines[newlines - 1] + 1;
+    int column = offset - line_start + 1;
+    COUNT_COMP(1);
+    if (!index->ascii) {
+        for (int i = line_start; i < offset; i++) {
+            if (((unsigned char)input[i] & 0xC0) == 0x80) {
+                column--;
+            }
+            COUNT_COMP(1);
+        }
+    }
+    return column;
+}
+
+/**
+ * Column (from 1) of the character at offset, which has newlines '\n' before it
+ * Same as column_of_offset, but only the bytes between the cursor and offset are read
+ * when offset is after the cursor on its line; otherwise it starts again at the line start
+ */
+int column_cursor_seek(ColumnCursor* cursor, const LineIndex* index, const char* input, int newlines, int offset) {
+    int line_start = newlines == 0 ? 0 : index->newlines[newlines - 1] + 1;
+    COUNT_COMP(2);
+    if (line_start != cursor->line_start || offset < cursor->offset) {
+        cursor->line_start = line_start;
+        cursor->offset = line_start;
+        cursor->before = 0;
+    }
+    cursor->before += offset - cursor->offset;
+    COUNT_COMP(1);
+    if (!index->ascii) {
+        for (int i = cursor->offset; i < offset; i++) {
+            if (((unsigned char)input[i] & 0xC0) == 0x80) {
+                cursor->before--;
+            }
+            COUNT_COMP(1);
+        }
+    }
+    cursor->offset = offset;
+    COUNT_GEN(3);
+    return cursor->before + 1;
+}
@@ -0,0 +1,207 @@
+/*
+ * -----------------------------------------------------------------------------
+ * scan_parallel.c
+ *
+ * Parallel driver of the Scanner (-jobs N).
+ * The input (status.input) is split in chunks at newline boundaries and every
+ * chunk is scanned by its own thread with scan_token. The automata tables are
+ * read only and every chunk has its own AutomataList (engine and cursors);
+ * status is per thread, so the chunk carries the input to its thread.
+ *
+ * Merge (in order, main thread):
+ * - A chunk starts at the beginning of a line, so its tokens are valid if the
+ *   previous chunk ended between tokens. Tokens only have offsets in the input
+ *   (the lines come from status.lines when they are written), so nothing has
+ *   to be adjusted.
+ * - No token holds a newline (a literal ends at its line and so does a
+ *   runaway token), so chunks end between tokens. If one does not (it ran out
+ *   of memory, or a rule that crosses lines is added to tokens.spec), the
+ *   chunk is rescanned from the end of the last token written until a token
+ *   starts at the same offset as one of the chunk, from there the chunk
+ *   tokens are used again.
+ * - Tokens are written with output_token(), so the .cscn is byte for byte the
+ *   one of automata_driver.
+ *
+ * The operation counts (DEBUG) of every chunk are kept apart on its thread
+ * and added to the ones of the main thread after the merge, so the summary
+ * is the work of all the threads. The -countlog trace is sequential: with it
+ * automata_driver does not split the input.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include "module_automata.h"
+#include "../count.h"
+#include <string.h>
+
+#ifndef _WIN32
+    #include <pthread.h>
+#endif
+
+#define MAX_SCAN_JOBS 64                // Maximum number of chunks / threads
+#define MIN_CHUNK_SIZE (64 * 1024)      // Smaller chunks are not worth a thread
+
+typedef struct ScanChunk {
+    const char *input;  // status.input of the main thread (status is per thread)
+    int len;            // status.input_len of the main thread
+    int start;          // Chunk = status.input[start .. end), start is the beginning of a line
+    int end;
+    int stop;           // Position right after the last token that starts in the chunk
+    Token *tokens;      // Tokens that start in the chunk
+    int count;
+    int capacity;
+    bool failed;        // Out of memory: the chunk is rescanned in the merge
+    AutomataList automata;  // Cursors of this chunk (lockstep engine)
+    bool counting;      // count_state.active of the main thread
+    CountState counts;  // Operation counts of this chunk (count is per thread too)
+} ScanChunk;
+
+static bool chunk_add_token(ScanChunk *chunk, const Token *token){
+    if (chunk->count == chunk->capacity){
+        int capacity = chunk->capacity ? chunk->capacity * 2 : 1024;
+        Token *tokens = realloc(chunk->tokens, capacity * sizeof(Token));
+        if (!tokens){
+            return false;
+        }
+        chunk->tokens = tokens;
+        chunk->capacity = capacity;
+    }
+    chunk->tokens[chunk->count++] = *token;
+    return true;
+}
+
+// Thread body: scans the tokens that start in the chunk (the last one can end after it)
+static void* scan_chunk(void *arg){
+    ScanChunk *chunk = (ScanChunk*)arg;
+    CountSaved saved;
+    count_chunk_begin(&saved, chunk->counting);
+    int idx = chunk->start;
+    chunk->stop = chunk->start;
+    while (true){
+        Token token = scan_token(chunk->input, chunk->len, &idx, &chunk->automata);
+        if (token.len == 0 || token.offset >= chunk->end){ // Aquest token ja és del tros següent
+            break;
+        }
+        if (!chunk_add_token(chunk, &token)){
+            chunk->failed = true;
+            break;
+        }
+        chunk->stop = idx;
+    }
+    count_chunk_end(&saved, &chunk->counts);
+    return NULL;
+}
+
+// Splits status.input at newlines in (at most) num_jobs chunks of similar size
+static int split_chunks(ScanChunk *chunks, int num_jobs){
+    int len = status.input_len;
+    int count = 0;
+    int start = 0;
+    for (int k = 1; k <= num_jobs && start < len; k++){
+        int end = len;
+        if (k < num_jobs){
+            int target = (int)((long long)len * k / num_jobs);
+            if (target < start){
+                target = start;
+            }
+            const char *nl = memchr(status.input + target, END_OF_LINE, len - target);
+            end = nl ? (int)(nl - status.input) + 1 : len; // El tros següent comença a l'inici d'una línia
+        }
+        if (end <= start){
+            continue;
+        }
+        memset(&chunks[count], 0, sizeof(ScanChunk));
+        chunks[count].start = start;
+        chunks[count].end = end;
+        count++;
+        start = end;
+    }
+    return count;
+}
+
+// Writes the tokens of every chunk in order, rescanning where a chunk did not start between tokens
+static void merge_chunks(ScanChunk *chunks, int count, AutomataList *automata_list){
+    int pos = 0;        // Position right after the last written token
+    for (int k = 0; k < count; k++){
+        ScanChunk *chunk = &chunks[k];
+        if (!chunk->failed && pos <= chunk->start){ // Entre pos i el tros només hi ha blancs
+            for (int j = 0; j < chunk->count; j++){
+                output_token(&chunk->tokens[j]);
+            }
+            if (chunk->count > 0){
+                pos = chunk->stop;
+            }
+        } else { // El tros comença dins d'un token: es torna a escanejar fins que coincideix
+            int j = 0;
+            while (true){
+                int previous = pos;
+                Token token = scan_token(status.input, status.input_len, &pos, automata_list);
+                if (token.len == 0 || token.offset >= chunk->end){
+                    pos = previous;
+                    break;
+                }
+                while (j < chunk->count && chunk->tokens[j].offset < token.offset){
+                    j++;
+                }
+                if (!chunk->failed && j < chunk->count && chunk->tokens[j].offset == token.offset){
+                    for (; j < chunk->count; j++){ // Mateix inici de token: la resta del tros és igual
+                        output_token(&chunk->tokens[j]);
+                    }
+                    pos = chunk->stop;
+                    break;
+                }
+                output_token(&token);
+            }
+        }
+    }
+}
+
+bool scan_parallel(AutomataList *automata_list, int num_jobs){
+#ifdef _WIN32
+    (void)num_jobs;
+    return false;   // Sense pthreads: automata_driver fa l'escaneig seqüencial
+#else
+    if (num_jobs > MAX_SCAN_JOBS){
+        num_jobs = MAX_SCAN_JOBS;
+    }
+    if (num_jobs > status.input_len / MIN_CHUNK_SIZE){
+        num_jobs = status.input_len / MIN_CHUNK_SIZE;
+    }
+    if (num_jobs < 2){
+        return false;
+    }
+
+    ScanChunk chunks[MAX_SCAN_JOBS];
+    pthread_t threads[MAX_SCAN_JOBS];
+    bool started[MAX_SCAN_JOBS];
+    int count = split_chunks(chunks, num_jobs);
+    for (int k = 0; k < count; k++){
+        chunks[k].input = status.input;
+        chunks[k].len = status.input_len;
+        chunks[k].automata = *automata_list;   // Mateixes taules, cursors propis
+        chunks[k].counting = count_state.active;
+    }
+
+    for (int k = 1; k < count; k++){
+        started[k] = pthread_create(&threads[k], NULL, scan_chunk, &chunks[k]) == 0;
+    }
+    scan_chunk(&chunks[0]);     // El primer tros el fa aquest fil
+    for (int k = 1; k < count; k++){
+        if (started[k]){
+            pthread_join(threads[k], NULL);
+        } else {
+            scan_chunk(&chunks[k]);
+        }
+    }
+
+    merge_chunks(chunks, count, automata_list);
+
+    for (int k = 0; k < count; k++){
+        count_merge(&chunks[k].counts);
+        free(chunks[k].tokens);
+    }
+    return true;
+#endif
+}
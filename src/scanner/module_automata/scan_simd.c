@@ -0,0 +1,448 @@
+/*
+ * -----------------------------------------------------------------------------
+ * scan_simd.c
+ *
+ * Vectorized kernels of the Scanner for the long runs of bytes that do not
+ * need the DFA one character at a time:
+ * - skip_blanks(): spaces, tabs and line breaks between tokens
+ * - find_run_end(): first stop byte of a run state of the combined DFA, e.g.
+ *   the closing '"' of a literal body (never past a limit: runaway literals)
+ * - build_line_index(): offsets of every '\n' of the input, in one pass; the
+ *   line and column of a token are computed from them only when needed. The
+ *   same loads validate UTF-8: a block without high bits is ASCII with no
+ *   more work, the sequences of the rest are checked (columns count
+ *   characters, invalid bytes are reported)
+ *
+ * Versions: AVX2 (32 bytes, chosen at run time if the processor has it), SSE2
+ * (16 bytes, always on x86-64) and a scalar loop for the other targets.
+ * The operation counts (DEBUG) are charged by the dispatchers from the bytes
+ * scanned, one per COUNT_BLOCK bytes, not by the kernels: they are the same
+ * whatever version runs, so the count baselines match on every machine.
+ * The input is only NUL-terminated (no padding), so the vector loops use
+ * aligned loads: an aligned block never crosses a page, and the loops stop in
+ * the block of the '\0' (it is never a blank and always a stop byte). The
+ * whole input pass (build_line_index) knows its length and uses unaligned
+ * loads up to the last full block.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include "module_automata.h"
+#include "../count.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -DSCAN_NO_SIMD compiles only the scalar loops (to compare or debug them)
+#if !defined(SCAN_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define SCAN_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+#if SCAN_SSE2 && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define SCAN_AVX2 1
+    #include <immintrin.h>
+#endif
+
+#if SCAN_SSE2
+#ifdef _MSC_VER
+    #include <intrin.h>
+    static inline int first_bit(uint32_t mask){
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (int)index;
+    }
+#else
+    static inline int first_bit(uint32_t mask){
+        return __builtin_ctz(mask);
+    }
+#endif
+#endif
+
+/* ---------------------------------------------------------------- scalar -- */
+
+static int skip_blanks_scalar(const char *input, int i){
+    while (is_blank_char(input[i])){
+        i++;
+    }
+    return i;
+}
+
+// Room for block more offsets (one vector block can hold that many '\n')
+static bool line_index_reserve(LineIndex *index, int block){
+    if (index->count + block <= index->capacity){
+        return true;
+    }
+    int capacity = index->capacity ? index->capacity * 2 : 1024;
+    while (capacity < index->count + block){
+        capacity *= 2;
+    }
+    int *newlines = realloc(index->newlines, capacity * sizeof(int));
+    if (!newlines){
+        return false;
+    }
+    index->newlines = newlines;
+    index->capacity = capacity;
+    return true;
+}
+
+/**
+ * Length of the UTF-8 sequence at p (left bytes available), 0 if it is not valid:
+ * overlong forms, surrogates (U+D800..U+DFFF) and code points over U+10FFFF are invalid
+ */
+static int utf8_sequence(const unsigned char *p, int left){
+    unsigned char c = p[0];
+    int len;
+    unsigned char low = 0x80, high = 0xBF;  // Rang del segon byte
+    if (c < 0x80){
+        return 1;
+    } else if (c >= 0xC2 && c <= 0xDF){
+        len = 2;
+    } else if (c >= 0xE0 && c <= 0xEF){
+        len = 3;
+        if (c == 0xE0) low = 0xA0;          // Forma massa llarga
+        if (c == 0xED) high = 0x9F;         // Suplents
+    } else if (c >= 0xF0 && c <= 0xF4){
+        len = 4;
+        if (c == 0xF0) low = 0x90;
+        if (c == 0xF4) high = 0x8F;         // Més enllà de U+10FFFF
+    } else {
+        return 0;
+    }
+    if (left < len || p[1] < low || p[1] > high){
+        return 0;
+    }
+    for (int k = 2; k < len; k++){
+        if ((p[k] & 0xC0) != 0x80){
+            return 0;
+        }
+    }
+    return len;
+}
+
+// Validates the sequence at input[i] (not ASCII) and returns the position after it
+static int check_utf8_sequence(LineIndex *index, const char *input, int i, int len){
+    int seq = utf8_sequence((const unsigned char*)input + i, len - i);
+    index->ascii = false;
+    COUNT_GEN(1);
+    COUNT_COMP(1);
+    if (seq == 0){ // Un byte invàlid: es compta i es continua amb el següent
+        if (index->invalid_utf8++ == 0){
+            index->first_invalid_utf8 = i;
+        }
+        return i + 1;
+    }
+    return i + seq;
+}
+
+int utf8_char_len(const char *p){
+    int seq = utf8_sequence((const unsigned char*)p, 4); // Acabat en '\0': no passa mai del final
+    COUNT_GEN(1);
+    return seq > 0 ? seq : 1;
+}
+
+/**
+ * Rest of build_line_index from input[from] (the last bytes, or all of them without SIMD):
+ * the '\n' with memchr and the UTF-8 sequences from checked (the bytes before it are validated)
+ */
+static bool build_line_index_scalar(LineIndex *index, const char *input, int from, int checked, int len){
+    const char *p = input + from;
+    const char *end = input + len;
+    while ((p = memchr(p, END_OF_LINE, end - p)) != NULL){
+        if (!line_index_reserve(index, 1)){
+            return false;
+        }
+        index->newlines[index->count++] = (int)(p - input);
+        p++;
+    }
+    int i = checked > from ? checked : from;
+    while (i < len){
+        if ((unsigned char)input[i] < 0x80){
+            i++;
+        } else {
+            i = check_utf8_sequence(index, input, i, len);
+        }
+    }
+    return true;
+}
+
+#if !SCAN_SSE2
+static bool is_stop(char c, const uint8_t *stops, int num_stops){
+    for (int k = 0; k < num_stops; k++){
+        if ((uint8_t)c == stops[k]){
+            return true;
+        }
+    }
+    return c == '\0';
+}
+
+static int find_run_end_scalar(const char *input, int i, int limit, const uint8_t *stops, int num_stops){
+    while (i < limit && !is_stop(input[i], stops, num_stops)){
+        i++;
+    }
+    return i;
+}
+#endif
+
+/* ------------------------------------------------------------------ SSE2 -- */
+
+#if SCAN_SSE2
+static int skip_blanks_sse2(const char *input, int i){
+    const __m128i space = _mm_set1_epi8(SPACE_CHAR);
+    const __m128i tab = _mm_set1_epi8(TAB_CHAR);
+    const __m128i newline = _mm_set1_epi8(END_OF_LINE);
+    const __m128i cr = _mm_set1_epi8(CARRIAGE_RETURN);
+
+    // Primer bloc alineat: els bytes d'abans de input + i no compten
+    const char *p = input + i;
+    uintptr_t misalign = (uintptr_t)p & 15;
+    const __m128i *block = (const __m128i*)(p - misalign);
+    uint32_t ignore = (1u << misalign) - 1;
+    while (true){
+        __m128i v = _mm_load_si128(block);
+        __m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+                                     _mm_or_si128(_mm_cmpeq_epi8(v, newline), _mm_cmpeq_epi8(v, cr)));
+        uint32_t other = ~(uint32_t)_mm_movemask_epi8(blank) & 0xFFFF & ~ignore;
+        if (other){
+            return (int)((const char*)block - input) + first_bit(other);
+        }
+        ignore = 0;
+        block++;
+    }
+}
+
+static int find_run_end_sse2(const char *input, int i, int limit, const uint8_t *stops, int num_stops){
+    __m128i stop[MAX_RUN_STOPS];
+    for (int k = 0; k < num_stops; k++){
+        stop[k] = _mm_set1_epi8((char)stops[k]);
+    }
+    const __m128i zero = _mm_setzero_si128();
+
+    const char *p = input + i;
+    uintptr_t misalign = (uintptr_t)p & 15;
+    const __m128i *block = (const __m128i*)(p - misalign);
+    uint32_t ignore = (1u << misalign) - 1;
+    while (true){
+        __m128i v = _mm_load_si128(block);
+        __m128i hit = _mm_cmpeq_epi8(v, zero);
+        for (int k = 0; k < num_stops; k++){
+            hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, stop[k]));
+        }
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(hit) & ~ignore;
+        if (mask){
+            int end = (int)((const char*)block - input) + first_bit(mask);
+            return end < limit ? end : limit;
+        }
+        ignore = 0;
+        block++;
+        if ((const char*)block - input >= limit){
+            return limit;
+        }
+    }
+}
+
+/**
+ * Validates the sequences that start at the non-ASCII bytes of a block (bit k of high: input[i + k]).
+ * checked is the first byte not validated yet (a sequence can go on in the next block); returns it
+ */
+static int check_utf8_block(LineIndex *index, const char *input, int i, uint32_t high, int checked, int len){
+    while (high){
+        int at = i + first_bit(high);
+        high &= high - 1;
+        if (at >= checked){ // Si no, és un byte de continuació d'una seqüència ja validada
+            checked = check_utf8_sequence(index, input, at, len);
+        }
+    }
+    return checked;
+}
+
+static bool build_line_index_sse2(LineIndex *index, const char *input, int len){
+    const __m128i newline = _mm_set1_epi8(END_OF_LINE);
+    int i = 0;
+    int checked = 0;
+    for (; i + 16 <= len; i += 16){
+        __m128i block = _mm_loadu_si128((const __m128i*)(input + i));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+        uint32_t high = (uint32_t)_mm_movemask_epi8(block);   // Bytes no ASCII
+        if (mask){
+            if (!line_index_reserve(index, 16)){
+                return false;
+            }
+            while (mask){ // Un offset per cada bit
+                index->newlines[index->count++] = i + first_bit(mask);
+                mask &= mask - 1;
+            }
+        }
+        if (high){
+            checked = check_utf8_block(index, input, i, high, checked, len);
+        }
+    }
+    return build_line_index_scalar(index, input, i, checked, len);
+}
+#endif
+
+/* ------------------------------------------------------------------ AVX2 -- */
+
+#if SCAN_AVX2
+__attribute__((target("avx2")))
+static int skip_blanks_avx2(const char *input, int i){
+    const __m256i space = _mm256_set1_epi8(SPACE_CHAR);
+    const __m256i tab = _mm256_set1_epi8(TAB_CHAR);
+    const __m256i newline = _mm256_set1_epi8(END_OF_LINE);
+    const __m256i cr = _mm256_set1_epi8(CARRIAGE_RETURN);
+
+    const char *p = input + i;
+    uintptr_t misalign = (uintptr_t)p & 31;
+    const __m256i *block = (const __m256i*)(p - misalign);
+    uint32_t ignore = (uint32_t)((1ull << misalign) - 1);
+    while (true){
+        __m256i v = _mm256_load_si256(block);
+        __m256i blank = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(v, newline), _mm256_cmpeq_epi8(v, cr)));
+        uint32_t other = ~(uint32_t)_mm256_movemask_epi8(blank) & ~ignore;
+        if (other){
+            return (int)((const char*)block - input) + first_bit(other);
+        }
+        ignore = 0;
+        block++;
+    }
+}
+
+__attribute__((target("avx2")))
+static int find_run_end_avx2(const char *input, int i, int limit, const uint8_t *stops, int num_stops){
+    __m256i stop[MAX_RUN_STOPS];
+    for (int k = 0; k < num_stops; k++){
+        stop[k] = _mm256_set1_epi8((char)stops[k]);
+    }
+    const __m256i zero = _mm256_setzero_si256();
+
+    const char *p = input + i;
+    uintptr_t misalign = (uintptr_t)p & 31;
+    const __m256i *block = (const __m256i*)(p - misalign);
+    uint32_t ignore = (uint32_t)((1ull << misalign) - 1);
+    while (true){
+        __m256i v = _mm256_load_si256(block);
+        __m256i hit = _mm256_cmpeq_epi8(v, zero);
+        for (int k = 0; k < num_stops; k++){
+            hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, stop[k]));
+        }
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(hit) & ~ignore;
+        if (mask){
+            int end = (int)((const char*)block - input) + first_bit(mask);
+            return end < limit ? end : limit;
+        }
+        ignore = 0;
+        block++;
+        if ((const char*)block - input >= limit){
+            return limit;
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static bool build_line_index_avx2(LineIndex *index, const char *input, int len){
+    const __m256i newline = _mm256_set1_epi8(END_OF_LINE);
+    int i = 0;
+    int checked = 0;
+    for (; i + 32 <= len; i += 32){
+        __m256i block = _mm256_loadu_si256((const __m256i*)(input + i));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline));
+        uint32_t high = (uint32_t)_mm256_movemask_epi8(block);
+        if (mask){
+            if (!line_index_reserve(index, 32)){
+                return false;
+            }
+            while (mask){
+                index->newlines[index->count++] = i + first_bit(mask);
+                mask &= mask - 1;
+            }
+        }
+        if (high){
+            checked = check_utf8_block(index, input, i, high, checked, len);
+        }
+    }
+    return build_line_index_scalar(index, input, i, checked, len);
+}
+
+// __builtin_cpu_supports només llegeix una variable inicialitzada a l'arrencada
+static inline bool has_avx2(void){
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+/* ------------------------------------------------------------- dispatch -- */
+
+#define COUNT_BLOCK 16  // Bytes of a kernel charged as one operation, whatever the vector width
+
+// Operations of a kernel that went over bytes bytes (the last block is a partial one)
+static inline int kernel_blocks(int bytes){
+    return bytes / COUNT_BLOCK + 1;
+}
+
+static int skip_blanks_kernel(const char *input, int i){
+#if SCAN_AVX2
+    if (has_avx2()){
+        return skip_blanks_avx2(input, i);
+    }
+#endif
+#if SCAN_SSE2
+    return skip_blanks_sse2(input, i);
+#else
+    return skip_blanks_scalar(input, i);
+#endif
+}
+
+int skip_blanks(const char *input, int i){
+    COUNT_COMP(2);
+    if (!is_blank_char(input[i]) || !is_blank_char(input[i + 1])){ // Cap blanc o un de sol: no val la pena vectoritzar
+        return skip_blanks_scalar(input, i);
+    }
+    int end = skip_blanks_kernel(input, i);
+    COUNT_COMP(kernel_blocks(end - i));
+    return end;
+}
+
+static int find_run_end_kernel(const char *input, int i, int limit, const uint8_t *stops, int num_stops){
+#if SCAN_AVX2
+    if (has_avx2()){
+        return find_run_end_avx2(input, i, limit, stops, num_stops);
+    }
+#endif
+#if SCAN_SSE2
+    return find_run_end_sse2(input, i, limit, stops, num_stops);
+#else
+    return find_run_end_scalar(input, i, limit, stops, num_stops);
+#endif
+}
+
+int find_run_end(const char *input, int i, int limit, const uint8_t *stops, int num_stops){
+    int end = find_run_end_kernel(input, i, limit, stops, num_stops);
+    COUNT_COMP(kernel_blocks(end - i));
+    return end;
+}
+
+static bool build_line_index_kernel(LineIndex *index, const char *input, int len){
+#if SCAN_AVX2
+    if (has_avx2()){
+        return build_line_index_avx2(index, input, len);
+    }
+#endif
+#if SCAN_SSE2
+    return build_line_index_sse2(index, input, len);
+#else
+    return build_line_index_scalar(index, input, 0, 0, len);
+#endif
+}
+
+bool build_line_index(LineIndex *index, const char *input, int len){
+    index->count = 0;
+    index->ascii = true;
+    index->invalid_utf8 = 0;
+    index->first_invalid_utf8 = -1;
+    bool built = build_line_index_kernel(index, input, len);
+    COUNT_COMP(2 * kernel_blocks(len));     // '\n' i bytes no ASCII de cada bloc
+    COUNT_GEN(index->count);                // Un offset per salt de línia
+    return built;
+}
@@ -0,0 +1,417 @@
+/*
+ * -----------------------------------------------------------------------------
+ * scan_token.c
+ *
+ * Automata execution engine for the Scanner module: the next token of an
+ * input buffer (scan_token). Implements DFA (Deterministic Finite Automata)
+ * operations including: state transitions, acceptance state checking, and
+ * token recognition.
+ *
+ * Key Functions:
+ * - init_automata_list(): Automata of the tables, with their cursors at the start
+ * - is_accepting_state(): Checks if a state is an accepting state
+ * - restart_automatas(): Starts the automata that can begin with the first byte
+ * - classify_identifier(): Keyword/type lookup (perfect hash) of identifiers
+ * - scan_token(): Next token of the input
+ *
+ * Blanks between tokens and the run states of the combined DFA (literal bodies)
+ * are skipped with the vectorized kernels of scan_simd.c.
+ *
+ * Features:
+ * - Combined DFA engine: one table transition per character (default)
+ * - Lockstep engine: every automaton stepped on its own (-lockstep), only the
+ *   ones the first byte can start (first_byte table) and while they run (mask)
+ * - Vector engine: the same automata stepped at once in vector lanes (-vector,
+ *   scan_vector.c)
+ * - Lookahead capability for complex token recognition
+ * - Longest match: every engine remembers the last accepting prefix while it
+ *   steps, and a token that stops in a non-accepting state goes back to it
+ *   (finish_unaccepted)
+ *
+ * All the state of a scan is in the AutomataList and the position: nothing is
+ * read from status and nothing is written (errors come in token.error), so
+ * automata_driver and module_api share it (scanner_core, see CMakeLists.txt).
+ *
+ * Team: GA
+ * Contributor/s: Pol García, Clara Serra, Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include "module_automata.h"
+#include "../count.h"
+#include <string.h>
+
+
+// Automata of the tables (ALL_AUTOMATA) with their cursors at the start state, scanning with engine
+void init_automata_list(AutomataList* automata_list, Engine engine){
+    automata_list->num_automata = NUM_AUTOMATA;
+    for(int i = 0; i < NUM_AUTOMATA; i++){
+        automata_list->automatas[i] = ALL_AUTOMATA[i];
+        automata_list->cursors[i].current_state = ALL_AUTOMATA[i]->start_state; // Les taules no es modifiquen, només el cursor
+    }
+    memcpy(automata_list->first_byte, FIRST_BYTE_AUTOMATA, sizeof(automata_list->first_byte)); // Mateix ordre que ALL_AUTOMATA
+    automata_list->active = 0;
+    automata_list->engine = engine;
+    COUNT_GEN(NUM_AUTOMATA);
+}
+
+bool is_accepting_state(const AutomataDFA *a, int state){
+    COUNT_GEN(1);  // One bit test in the accepting bitset
+    return (a->accepting[state >> 3] >> (state & 7)) & 1;
+}
+
+// Index of the lowest bit set of a non-zero mask (the automaton with most priority)
+#ifdef _MSC_VER
+    #include <intrin.h>
+    static inline int lowest_automata(uint64_t mask){
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return (int)index;
+    }
+#else
+    static inline int lowest_automata(uint64_t mask){
+        return __builtin_ctzll(mask);
+    }
+#endif
+
+void restart_automatas(AutomataList *list, char first){
+    uint64_t active = list->first_byte[(unsigned char)first]; // Els altres es morien amb el primer caràcter
+    list->active = active;
+    COUNT_GEN(2);
+    while (active){ // Només es reinicien els autòmata que poden començar el token
+        int i = lowest_automata(active);
+        list->cursors[i].current_state = list->automatas[i]->start_state;
+        active &= active - 1;
+        COUNT_GEN(2);
+    }
+}
+
+Category classify_identifier(const char *lexeme, int len){
+    COUNT_COMP(1);
+    if (len > RESERVED_MAX_LEN){
+        return CAT_IDENTIFIER;
+    }
+    const ReservedWord *entry = &RESERVED_WORDS[reserved_hash(RESERVED_SEED, lexeme, len) & RESERVED_MASK];
+    COUNT_GEN(2);
+    COUNT_COMP(2);
+    if (entry->len == len && memcmp(entry->word, lexeme, len) == 0){ // Només una paraula pot caure en cada slot
+        return entry->cat;
+    }
+    return CAT_IDENTIFIER;
+}
+
+/**
+ * Actualitza l'estat d'un autòmata amb el caràcter llegit
+ * @param a Punter a l'autòmata DFA (taules, només lectura)
+ * @param cursor Estat de l'autòmata en aquest escaneig
+ * @param c Caràcter a processar
+ * @param lookahead_char Següent caràcter (per verificar lookahead), EOF al final de l'entrada
+ * @return CORRECT_RETURN si continua amb el lookahead, ACCEPT_TOKEN si s'atura en un estat
+ *         d'acceptació, STOP_AUTOMATA si s'atura sense acceptar
+ */
+static int update_automata(const AutomataDFA *a, AutomataCursor *cursor, char c, int lookahead) {
+
+    int new_state = automata_transition(a, cursor->current_state, a->class_of[(unsigned char)c]); //Column of the character: its class
+
+    cursor->current_state = new_state; //Update Automata
+
+    COUNT_GEN(3);
+    
+    COUNT_COMP(1);
+    if (new_state == 0)             //This can only happen if the character is the first to be put from initial state. So we would already stop the automata,
+        return STOP_AUTOMATA;       // In any other case we would have seen the Lookahead going to NULL state
+
+    int lookahead_state = lookahead == EOF ? 0 : automata_transition(a, new_state, a->class_of[(unsigned char)lookahead]); //See where we would go in the next step (with the lookahead)
+
+    COUNT_GEN(2);
+    COUNT_COMP(2);
+    if (lookahead_state == 0){  //If in the next step we would go to NULL state this automaton has finished
+        bool accept_token = is_accepting_state(a, new_state); 
+        COUNT_GEN(2);
+        COUNT_COMP(1);
+        if (accept_token)       //If we are in an accepting state it can accept the TOKEN
+            return ACCEPT_TOKEN;
+        return STOP_AUTOMATA;   //Else it rejects the TOKEN
+    }
+    COUNT_GEN(1);
+    return CORRECT_RETURN;
+}
+
+/**
+ * Processa un caràcter amb els autòmata actius (list->active), un per un (engine de referència)
+ * El token acaba quan cap autòmata pot continuar amb el lookahead; llavors guanya el primer
+ * autòmata de la llista (més prioritat) que ha acabat en un estat d'acceptació.
+ * L'ordre és sempre el de ALL_AUTOMATA: amb longest match un autòmata que encara avança pot
+ * donar un token més llarg, així que no hi ha cap sortida anticipada i reordenar-los (p.ex.
+ * pels que més accepten) no estalviaria cap pas.
+ * restart_automatas() ha de triar els actius amb el primer caràcter del token.
+ * @param prefix Si el token continua: categoria del primer autòmata que accepta el prefix
+ *               llegit fins ara (segueixi o no), COMBINED_REJECT si cap
+ * @return Category acceptada, COMBINED_REJECT si el token acaba sense acceptar,
+ *         COMBINED_CONTINUE si el token continua
+ */
+static int lockstep_step(AutomataList *automata_list, char c, int lookahead, int *prefix){
+    int accepted = COMBINED_REJECT;
+    uint64_t active = automata_list->active;
+    uint64_t still = 0;     // Els que poden continuar amb el lookahead
+    COUNT_GEN(3);
+    while (active){ // Bits en ordre creixent: ordre de prioritat
+        int i = lowest_automata(active);
+        active &= active - 1;
+        const AutomataDFA *a = automata_list->automatas[i];
+        int decision = update_automata(a, &automata_list->cursors[i], c, lookahead);
+        COUNT_GEN(3);
+
+        COUNT_COMP(1);
+        if (decision == CORRECT_RETURN){ // Pot continuar amb el lookahead
+            still |= (uint64_t)1 << i;
+            COUNT_GEN(1);
+            COUNT_COMP(1);
+            if (accepted == COMBINED_REJECT && is_accepting_state(a, automata_list->cursors[i].current_state)){
+                accepted = a->type;  // El prefix ja és un token: s'hi torna si el més llarg no acaba acceptat
+            }
+            continue;
+        }
+        COUNT_COMP(2);
+        if (decision == ACCEPT_TOKEN && accepted == COMBINED_REJECT){ // El primer que accepta té prioritat
+            accepted = automata_list->automatas[i]->type;
+        }
+    }
+    automata_list->active = still; // Els que han acabat ja no es miren més
+    COUNT_GEN(1);
+
+    COUNT_COMP(1);
+    if (still){
+        *prefix = accepted;
+        return COMBINED_CONTINUE;
+    }
+    return accepted;
+}
+
+/**
+ * Processa un caràcter amb l'autòmata combinat: una sola transició de taula
+ * @param state Estat actual de l'autòmata combinat (tornat a l'inici si el token acaba)
+ * @return Igual que lockstep_step
+ */
+static int combined_step(const CombinedDFA *dfa, int *state, char c, int lookahead){
+    int new_state = dfa->next_state[*state * dfa->num_classes + dfa->class_of[(unsigned char)c]];
+    COUNT_GEN(1);
+
+    COUNT_COMP(3);
+    if (new_state != 0 && lookahead != EOF
+        && dfa->next_state[new_state * dfa->num_classes + dfa->class_of[(unsigned char)lookahead]] != 0){
+        *state = new_state;
+        COUNT_GEN(1);
+        return COMBINED_CONTINUE;
+    }
+    *state = dfa->start_state; // El token ha acabat (acceptat o no reconegut)
+    COUNT_GEN(1);
+    COUNT_COMP(1);
+    if (new_state != 0 && dfa->accept[new_state] >= 0){
+        return dfa->accept[new_state];
+    }
+    return COMBINED_REJECT;
+}
+
+// Cert si alguna regla pot començar un token amb c (transició des de l'estat inicial del DFA combinat)
+static bool can_start_token(char c){
+    const CombinedDFA *dfa = &COMBINED_AUTOMATA;
+    COUNT_GEN(1);
+    return dfa->next_state[dfa->start_state * dfa->num_classes + dfa->class_of[(unsigned char)c]] != 0;
+}
+
+/**
+ * Error d'un token fugit (no acaba on hauria, o passa de MAX_TOKEN_LEN): el nom surt de la
+ * categoria que s'estava reconeixent (pendent a l'estat del DFA combinat després del primer caràcter)
+ */
+static Error runaway_error(char first){
+    const CombinedDFA *dfa = &COMBINED_AUTOMATA;
+    int state = dfa->next_state[dfa->start_state * dfa->num_classes + dfa->class_of[(unsigned char)first]];
+    COUNT_GEN(2);
+    return dfa->pending[state] == CAT_LITERAL ? ERR_UNTERMINATED_LITERAL : ERR_TOKEN_TOO_LONG;
+}
+
+// Posició del primer '\n' des de start (o del '\0'): on s'acaba un token fugit
+static int end_of_line(const char *input, int start){
+    const char *nl = strchr(input + start, END_OF_LINE);
+    COUNT_GEN(1);
+    return nl ? (int)(nl - input) : start + (int)strlen(input + start);
+}
+
+/**
+ * Final d'un token que cap regla accepta o que passa de MAX_TOKEN_LEN (camí poc freqüent de scan_token)
+ * - Fugit (massa llarg) o literal sense tancar: *error i el token acaba al final de la seva línia,
+ *   així un '"' perdut dona un sol error i l'escaneig continua a la línia següent
+ * - Si un prefix del token s'acceptava (p.ex. "2" de "2.x" amb [0-9]+(\.[0-9]+)?), el token és
+ *   aquest prefix i l'escaneig continua just després: els engines ja l'han recordat mentre
+ *   avançaven (prefix_end), no es torna a llegir el token
+ * - Un caràcter no ASCII (cap regla en comença cap) és un token sencer: tota la seqüència UTF-8
+ * - Si no, no reconegut: s'hi afegeixen els caràcters ASCII seguits amb què cap regla pot començar
+ * @param i Posició on les regles han parat; s'avança (o es retrocedeix) just després del token
+ * @param scanned Darrer byte llegit (reach del token); creix si se n'han llegit més
+ * @param prefix_end Posició just després del darrer prefix acceptat, start si cap
+ * @param prefix_cat Categoria d'aquest prefix
+ * @return Categoria del prefix acceptat, o COMBINED_REJECT (CAT_NONRECOGNIZED)
+ */
+static int finish_unaccepted(const char *input, int start, int *i, int *scanned, int decision,
+                             int prefix_end, int prefix_cat, Error *error){
+    COUNT_COMP(2);
+    if (decision == COMBINED_CONTINUE || *i - start > MAX_TOKEN_LEN){
+        *error = runaway_error(input[start]);
+        *i = end_of_line(input, start);
+        return COMBINED_REJECT;
+    }
+    COUNT_COMP(2);
+    if (prefix_end > start){ // Maximal munch: retrocés al darrer estat d'acceptació
+        *i = prefix_end;
+        return prefix_cat;
+    }
+    if (runaway_error(input[start]) == ERR_UNTERMINATED_LITERAL){
+        *error = ERR_UNTERMINATED_LITERAL;
+        *i = end_of_line(input, start);
+        return COMBINED_REJECT;
+    }
+    COUNT_COMP(1);
+    if ((unsigned char)input[start] >= 0x80){ // Un token per caràcter: "汉字" són dos tokens
+        *i = start + utf8_char_len(input + start);
+        int read = start + 3;   // utf8_char_len pot llegir fins a 4 bytes
+        *scanned = read > *scanned ? read : *scanned;
+        return COMBINED_REJECT;
+    }
+    int end = *i;
+    // Només bytes ASCII 1..0x7F: el '\0' i els caràcters no ASCII (tokens propis) el tallen
+    while ((unsigned char)input[end] - 1u < 0x7Fu && !is_blank_char(input[end]) && !can_start_token(input[end])){
+        COUNT_COMP(3);
+        end++;
+    }
+    COUNT_COMP(1);
+    if (end - start > MAX_TOKEN_LEN){
+        *error = ERR_TOKEN_TOO_LONG;
+        end = end_of_line(input, start);
+    }
+    *i = end;
+    return COMBINED_REJECT;
+}
+
+/**
+ * Reconeix el següent token de input a partir de input[*idx]
+ * Salta els espais i salts de línia d'abans del token i després avança caràcter a caràcter
+ * (amb el lookahead) fins que el token acaba. El token és el prefix acceptat més llarg: cada
+ * engine recorda on ha passat per l'últim estat d'acceptació i, si el token acaba en un estat
+ * que no accepta, torna allà (sense tornar a llegir el token). Un lexema no reconegut
+ * s'allarga amb els caràcters següents que no poden començar cap token ("###" és un token).
+ * Les línies no es compten aquí: surten de l'offset amb l'índex de salts de línia.
+ * Un token fugit (literal sense tancar, o més llarg que MAX_TOKEN_LEN) no es segueix fins al
+ * final: es torna com a CAT_NONRECOGNIZED fins al final de la seva línia, amb token.error.
+ * Un '\0' abans de len no és el final: és un token CAT_NONRECOGNIZED d'un byte, amb ERR_NUL_BYTE.
+ * @param input Buffer d'entrada acabat en '\0' (input[len])
+ * @param len Longitud de l'entrada: l'escaneig acaba aquí, no al primer '\0'
+ * @param idx Posició actual; s'avança just després del token
+ * @return El token (offset i longitud dins de input, sense copiar el lexema);
+ *         longitud 0 si ja no queden tokens
+ */
+Token scan_token(const char* input, int len, int* idx, AutomataList* automata_list){
+    Token token;
+    int i = *idx;
+    COUNT_GEN(1);
+    i = skip_blanks(input, i); // Espais entre tokens (vectoritzat)
+    token.cat = CAT_NONRECOGNIZED;
+    token.offset = i;
+    token.len = 0;
+    token.error = ERR_NONE;
+    COUNT_GEN(4);
+
+    COUNT_COMP(1);
+    if (input[i] == '\0'){ // Final de l'entrada, o un '\0' a dins del fitxer
+        token.reach = i + 1;
+        COUNT_COMP(1);
+        if (i < len){ // Cap regla el llegeix (acaba els tokens com el final): un token d'un byte i es continua
+            token.len = 1;
+            token.error = ERR_NUL_BYTE;
+            i++;
+            COUNT_GEN(2);
+        }
+        *idx = i;
+        return token;
+    }
+
+    int start = i;
+    int decision = COMBINED_CONTINUE;
+    int combined_state = COMBINED_AUTOMATA.start_state;
+    int prefix_end = start;             // Darrer prefix acceptat (longest match)
+    int prefix_cat = COMBINED_REJECT;
+    COUNT_GEN(5);
+    COUNT_COMP(1);
+    if (automata_list->engine == ENGINE_COMBINED){
+        while (decision == COMBINED_CONTINUE){
+            int lookahead = input[i + 1] != '\0' ? (unsigned char)input[i + 1] : EOF;
+            decision = combined_step(&COMBINED_AUTOMATA, &combined_state, input[i], lookahead);
+            i++;
+            COUNT_COMP(2);
+            COUNT_GEN(2);
+            if (decision == COMBINED_CONTINUE && COMBINED_AUTOMATA.run_stops[combined_state] >= 0){
+                // Estat de recorregut (cos d'un literal): l'estat no canvia fins al proper byte d'aturada,
+                // es salta fins al caràcter d'abans (que encara s'ha de processar amb el seu lookahead)
+                int bound = start + MAX_TOKEN_LEN + 1; // Més enllà ja és un token fugit: no cal buscar on acaba
+                int end = find_run_end(input, i, bound, COMBINED_AUTOMATA.run_stop[combined_state],
+                                       COMBINED_AUTOMATA.run_stops[combined_state]);
+                COUNT_COMP(1);
+                if (end >= bound){
+                    i = bound;
+                    break;
+                }
+                if (end - 1 > i){
+                    i = end - 1;
+                }
+                COUNT_GEN(1);
+            }
+            COUNT_COMP(2);
+            if (decision == COMBINED_CONTINUE && COMBINED_AUTOMATA.accept[combined_state] >= 0){
+                prefix_end = i;     // L'estat no canvia dins d'un recorregut: també val després del salt
+                prefix_cat = COMBINED_AUTOMATA.accept[combined_state];
+                COUNT_GEN(2);
+            }
+        }
+    } else if (automata_list->engine == ENGINE_VECTOR){
+        decision = vector_token(input, &i, start + MAX_TOKEN_LEN + 1, &prefix_end, &prefix_cat); // CONTINUE al límit: token fugit
+    } else {
+        restart_automatas(automata_list, input[i]);
+        while (decision == COMBINED_CONTINUE){
+            int lookahead = input[i + 1] != '\0' ? (unsigned char)input[i + 1] : EOF;
+            int prefix = COMBINED_REJECT;
+            decision = lockstep_step(automata_list, input[i], lookahead, &prefix);
+            i++;
+            COUNT_COMP(4);
+            COUNT_GEN(3);
+            if (decision == COMBINED_CONTINUE && prefix >= 0){
+                prefix_end = i;
+                prefix_cat = prefix;
+                COUNT_GEN(2);
+            }
+        }
+    }
+
+    int scanned = i;    // L'últim byte llegit és el lookahead input[i]
+    COUNT_GEN(1);
+    COUNT_COMP(2);
+    if (decision < 0 || i - start > MAX_TOKEN_LEN){ // Camí poc freqüent: no acceptat o massa llarg
+        decision = finish_unaccepted(input, start, &i, &scanned, decision, prefix_end, prefix_cat, &token.error);
+    }
+
+    token.len = i - start;
+    token.reach = (scanned > i ? scanned : i) + 1; // Retrocés: s'ha llegit més enllà del final
+    COUNT_GEN(3);
+
+    COUNT_COMP(1);
+    if (decision >= 0){ // Algun autòmata ha acceptat el token (decision és la seva categoria)
+        token.cat = (Category)decision;
+        COUNT_COMP(1);
+        if (token.cat == CAT_IDENTIFIER){ // Paraules reservades: el mateix lexema pot ser keyword o type
+            token.cat = classify_identifier(input + start, token.len);
+        }
+    } // Si no, el lexema sencer queda com a CAT_NONRECOGNIZED
+
+    *idx = i;
+    COUNT_GEN(1);
+    return token;
+}
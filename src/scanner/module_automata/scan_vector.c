@@ -0,0 +1,201 @@
+/*
+ * -----------------------------------------------------------------------------
+ * scan_vector.c
+ *
+ * Vector engine of the Scanner (-vector): the lockstep engine with the states
+ * of all the rule automata packed in one register, lane i = ALL_AUTOMATA[i].
+ * Every byte is one step for all of them: the next states are read at once
+ * from VECTOR_AUTOMATA (interleaved [class][state][lane]), and again the states
+ * after the lookahead, instead of one update_automata per automaton. Small
+ * automata take the row of their state (one load per state), bigger ones a
+ * gather of every lane.
+ *
+ * Same decisions as lockstep_step: the token ends when no automaton can go on
+ * with the lookahead, and the lowest lane (highest priority) that stops in an
+ * accepting state in that step gives the category. While it goes on, the
+ * lowest lane in an accepting state marks the last accepted prefix.
+ *
+ * Versions: AVX2 (8 lanes per register, chosen at run time like scan_simd.c)
+ * and a scalar loop over the same packed table for the other targets.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include "module_automata.h"
+#include "../count.h"
+#include <stdint.h>
+
+// -DSCAN_NO_SIMD compiles only the scalar loop (to compare or debug it)
+#if !defined(SCAN_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define SCAN_AVX2 1
+    #include <immintrin.h>
+#endif
+
+#define MAX_VECTOR_GROUPS (MAX_AUTOMATAS / VECTOR_LANES)
+#define VECTOR_SELECT_STATES 8      // Up to this many states a row load per state beats a gather
+
+static inline int32_t vector_cell(const VectorAutomata *v, int column, int state, int lane){
+    return v->next[(column * v->num_states + state) * v->num_lanes + lane];
+}
+
+/* ---------------------------------------------------------------- scalar -- */
+
+static int vector_token_scalar(const VectorAutomata *v, const char *input, int *idx, int limit,
+                               int *prefix_end, int *prefix_cat){
+    int32_t state[MAX_AUTOMATAS];
+    for (int lane = 0; lane < v->num_lanes; lane++){
+        state[lane] = v->start[lane];
+    }
+    COUNT_GEN(v->num_lanes);
+
+    int i = *idx;
+    while (i < limit){
+        int column = v->class_of[(unsigned char)input[i]];
+        bool eof = input[i + 1] == '\0';
+        int look_column = v->class_of[(unsigned char)input[i + 1]];
+        bool continues = false;
+        int accepted = COMBINED_REJECT;
+        COUNT_GEN(5);
+        for (int lane = 0; lane < v->num_lanes; lane++){
+            int32_t cell = vector_cell(v, column, state[lane], lane);
+            int next = cell & VECTOR_STATE_MASK;
+            bool go_on = !eof && (vector_cell(v, look_column, next, lane) & VECTOR_STATE_MASK) != 0; // L'estat mort no surt de 0
+            state[lane] = go_on ? next : 0;
+            continues |= go_on;
+            COUNT_GEN(3);
+            COUNT_COMP(2);
+            if ((cell & VECTOR_ACCEPT) && accepted == COMBINED_REJECT){ // El primer que accepta té prioritat
+                accepted = v->type[lane];
+            }
+        }
+        i++;
+        COUNT_COMP(1);
+        if (!continues){
+            *idx = i;
+            return accepted;
+        }
+        COUNT_COMP(1);
+        if (accepted >= 0){ // Prefix acceptat: el token hi torna si acaba sense acceptar
+            *prefix_end = i;
+            *prefix_cat = accepted;
+            COUNT_GEN(2);
+        }
+    }
+    *idx = i;
+    return COMBINED_CONTINUE;
+}
+
+/* ------------------------------------------------------------------ AVX2 -- */
+
+#if SCAN_AVX2
+static inline int first_lane(uint32_t mask){
+    return __builtin_ctz(mask);
+}
+
+/**
+ * Cells [row + state][lane] of one group of lanes (row = class * num_states)
+ * Few states (VECTOR_SELECT_STATES): every row of the class is one vector load of the
+ * table, the lane takes the one of its state (compare and mask, no memory dependency).
+ * Otherwise one gather with the index of every lane.
+ */
+__attribute__((target("avx2")))
+static inline __m256i lane_cells(const VectorAutomata *v, int row, __m256i state, __m256i lane, int g){
+    COUNT_COMP(1);
+    if (v->num_states <= VECTOR_SELECT_STATES){
+        const int32_t *cells = v->next + row * v->num_lanes + g * VECTOR_LANES;
+        __m256i cell = _mm256_setzero_si256();
+        for (int s = 1; s < v->num_states; s++){ // L'estat mort (0) només va a 0
+            __m256i hit = _mm256_cmpeq_epi32(state, _mm256_set1_epi32(s));
+            cell = _mm256_or_si256(cell, _mm256_and_si256(hit, _mm256_loadu_si256((const __m256i*)(cells + s * v->num_lanes))));
+            COUNT_GEN(1);
+        }
+        return cell;
+    }
+    // index = (row + state) * num_lanes + lane
+    __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_add_epi32(_mm256_set1_epi32(row), state),
+                                                        _mm256_set1_epi32(v->num_lanes)), lane);
+    COUNT_GEN(1);
+    return _mm256_i32gather_epi32((const int*)v->next, index, 4);
+}
+
+__attribute__((target("avx2")))
+static int vector_token_avx2(const VectorAutomata *v, const char *input, int *idx, int limit,
+                             int *prefix_end, int *prefix_cat){
+    int groups = v->num_lanes / VECTOR_LANES;
+    __m256i state[MAX_VECTOR_GROUPS];
+    __m256i lane[MAX_VECTOR_GROUPS];   // Índex de cada carril dins d'una fila de la taula
+    for (int g = 0; g < groups; g++){
+        state[g] = _mm256_loadu_si256((const __m256i*)(v->start + g * VECTOR_LANES));
+        lane[g] = _mm256_add_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(g * VECTOR_LANES));
+    }
+    const __m256i state_mask = _mm256_set1_epi32(VECTOR_STATE_MASK);
+    const __m256i accept = _mm256_set1_epi32(VECTOR_ACCEPT);
+    const __m256i zero = _mm256_setzero_si256();
+    COUNT_GEN(2 * groups);
+
+    int i = *idx;
+    while (i < limit){
+        int row = v->class_of[(unsigned char)input[i]] * v->num_states;
+        int look_row = v->class_of[(unsigned char)input[i + 1]] * v->num_states;
+        bool eof = input[i + 1] == '\0';
+        uint32_t continues = 0;
+        int accepted = COMBINED_REJECT;
+        COUNT_GEN(5);
+        for (int g = 0; g < groups; g++){
+            COUNT_COMP(1);
+            if (_mm256_testz_si256(state[g], state[g])){ // Tots els carrils morts: res a llegir
+                continue;
+            }
+            __m256i cell = lane_cells(v, row, state[g], lane[g], g);
+            __m256i next = _mm256_and_si256(cell, state_mask);
+            __m256i go_on = zero;
+            if (!eof){ // Segueix si amb el lookahead no va a l'estat mort
+                __m256i look = _mm256_and_si256(lane_cells(v, look_row, next, lane[g], g), state_mask);
+                go_on = _mm256_xor_si256(_mm256_cmpeq_epi32(look, zero), _mm256_set1_epi32(-1));
+            }
+            state[g] = _mm256_and_si256(next, go_on);
+            uint32_t go_on_mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(go_on));
+            uint32_t accept_mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(
+                _mm256_cmpeq_epi32(_mm256_and_si256(cell, accept), accept)));
+            continues |= go_on_mask;
+            COUNT_GEN(4);
+            COUNT_COMP(2);
+            if (accept_mask && accepted == COMBINED_REJECT){ // Carril més baix: més prioritat
+                accepted = v->type[g * VECTOR_LANES + first_lane(accept_mask)];
+            }
+        }
+        i++;
+        COUNT_COMP(1);
+        if (!continues){
+            *idx = i;
+            return accepted;
+        }
+        COUNT_COMP(1);
+        if (accepted >= 0){
+            *prefix_end = i;
+            *prefix_cat = accepted;
+            COUNT_GEN(2);
+        }
+    }
+    *idx = i;
+    return COMBINED_CONTINUE;
+}
+
+// __builtin_cpu_supports només llegeix una variable inicialitzada a l'arrencada
+static inline bool has_avx2(void){
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+/* ------------------------------------------------------------- dispatch -- */
+
+int vector_token(const char *input, int *idx, int limit, int *prefix_end, int *prefix_cat){
+#if SCAN_AVX2
+    if (has_avx2()){
+        return vector_token_avx2(&VECTOR_AUTOMATA, input, idx, limit, prefix_end, prefix_cat);
+    }
+#endif
+    return vector_token_scalar(&VECTOR_AUTOMATA, input, idx, limit, prefix_end, prefix_cat);
+}
@@ -0,0 +1,32 @@
+# -----------------------------------------------------------------------------
+# tokens.spec
+#
+# Token specification of the Scanner, compiled at build time by
+# scanner_tablegen into minimized DFA tables (scanner_tables.c).
+#
+# One rule per line:   CATEGORY   PRIORITY   REGEX
+# - CATEGORY: Category enum name without the CAT_ prefix (one rule each)
+# - PRIORITY: lower value wins when several rules accept the same lexeme
+# A token is the longest prefix some rule accepts (e.g. with [0-9]+(\.[0-9]+)?
+# "2.x" is 2 . x): the scanner goes back to the last accepting position once.
+# - REGEX:    rest of the line; supports  | * + ? ( ) [a-z] [^...] .
+#             and the escapes \n \t \r \s (space) \xHH \<char>
+#
+# Reserved words:      CATEGORY   words   word word ...
+# They are not automata: the IDENTIFIER rule recognizes them and the lexeme
+# is then classified with a perfect hash table (any number of words, same cost).
+#
+# Team: GA
+# Contributor/s: Jan Prats
+# -----------------------------------------------------------------------------
+
+LITERAL         1   "[^"\n]*"
+# C punctuators (C11 6.4.6): one trie of the combined DFA, longest match.
+# Delimiters (and their digraphs <: :> <% %>) are SPECIALCHAR, the rest OPERATOR.
+OPERATOR        2   ->|\+\+|--|<<=?|>>=?|[<>=!]=?|&&|\|\||[*/%^&|+\-]=?|[~?:.]|\.\.\.|##?|%:(%:)?
+SPECIALCHAR     3   [;,(){}\[\]]|<:|:>|<%|%>
+NUMBER          4   [0-9]+(\.[0-9]+)?
+IDENTIFIER      5   [a-zA-Z_][a-zA-Z0-9_]*
+
+TYPE            words   int char void
+KEYWORD         words   if else while for return
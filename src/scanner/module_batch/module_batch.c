@@ -0,0 +1,156 @@
+/*
+ * -----------------------------------------------------------------------------
+ * module_batch.c
+ *
+ * Work-stealing pool of the batch mode (-batch).
+ * The files are split in contiguous blocks, one queue per worker. A worker
+ * takes its files from the bottom of its own queue and, when it is empty,
+ * steals from the top of the queue of the next workers. No file is added
+ * once the pool starts, so a worker that finds every queue empty is done.
+ *
+ * The files are coarse tasks (a whole scan each), so every queue has its own
+ * mutex instead of a lock-free deque.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include "module_batch.h"
+
+#ifndef _WIN32
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+#ifndef _WIN32
+
+typedef struct WorkQueue {
+    int top;                // Thieves take from here
+    int bottom;             // The owner takes from here (files top .. bottom-1 are pending)
+    pthread_mutex_t lock;
+} WorkQueue;
+
+typedef struct BatchPool {
+    char** files;
+    const Status* options;
+    BatchScanFn scan_file;
+    WorkQueue queues[MAX_BATCH_WORKERS];
+    int num_workers;
+    int* errors;            // Errors of each file
+} BatchPool;
+
+typedef struct BatchWorker {
+    BatchPool* pool;
+    int id;
+    pthread_t thread;
+} BatchWorker;
+
+static int queue_pop(WorkQueue* queue){
+    int file = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->top < queue->bottom){
+        file = --queue->bottom;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return file;
+}
+
+static int queue_steal(WorkQueue* queue){
+    int file = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->top < queue->bottom){
+        file = queue->top++;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return file;
+}
+
+// Next file of the worker: its own queue first, then the others (-1 if there are no files left)
+static int next_file(BatchPool* pool, int id){
+    int file = queue_pop(&pool->queues[id]);
+    for (int k = 1; file < 0 && k < pool->num_workers; k++){
+        file = queue_steal(&pool->queues[(id + k) % pool->num_workers]);
+    }
+    return file;
+}
+
+static void* batch_worker(void* arg){
+    BatchWorker* worker = (BatchWorker*)arg;
+    BatchPool* pool = worker->pool;
+    int file;
+    while ((file = next_file(pool, worker->id)) >= 0){
+        pool->errors[file] = pool->scan_file(pool->files[file], pool->options);
+    }
+    return NULL;
+}
+
+#endif // _WIN32
+
+int scan_batch(char** files, int num_files, int num_workers, const Status* options, BatchScanFn scan_file){
+    int total_errors = 0;
+#ifndef _WIN32
+    if (num_workers < 1){
+        num_workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (num_workers > MAX_BATCH_WORKERS){
+        num_workers = MAX_BATCH_WORKERS;
+    }
+    if (num_workers > num_files){
+        num_workers = num_files;
+    }
+
+    BatchPool* pool = calloc(1, sizeof(BatchPool));
+    int* errors = calloc(num_files, sizeof(int));
+    BatchWorker* workers = malloc(MAX_BATCH_WORKERS * sizeof(BatchWorker));
+    if (num_workers > 1 && pool && errors && workers){
+        pool->files = files;
+        pool->options = options;
+        pool->scan_file = scan_file;
+        pool->num_workers = num_workers;
+        pool->errors = errors;
+        for (int w = 0; w < num_workers; w++){ // Blocs contigus, un per worker
+            WorkQueue* queue = &pool->queues[w];
+            queue->top = (int)((long long)num_files * w / num_workers);
+            queue->bottom = (int)((long long)num_files * (w + 1) / num_workers);
+            pthread_mutex_init(&queue->lock, NULL);
+        }
+
+        for (int w = 0; w < num_workers; w++){
+            workers[w].pool = pool;
+            workers[w].id = w;
+        }
+        bool started[MAX_BATCH_WORKERS];
+        for (int w = 1; w < num_workers; w++){
+            started[w] = pthread_create(&workers[w].thread, NULL, batch_worker, &workers[w]) == 0;
+        }
+        batch_worker(&workers[0]);  // Aquest fil també és un worker
+        for (int w = 1; w < num_workers; w++){
+            if (started[w]){
+                pthread_join(workers[w].thread, NULL);
+            }
+        }
+        // Si un fil no s'ha pogut crear, els altres li han robat tots els fitxers
+
+        for (int w = 0; w < num_workers; w++){
+            pthread_mutex_destroy(&pool->queues[w].lock);
+        }
+        for (int i = 0; i < num_files; i++){
+            total_errors += errors[i];
+        }
+        free(pool);
+        free(errors);
+        free(workers);
+        return total_errors;
+    }
+    free(pool);
+    free(errors);
+    free(workers);
+#else
+    (void)num_workers;
+#endif
+    for (int i = 0; i < num_files; i++){ // Un sol worker (o sense threads): un fitxer rere l'altre
+        total_errors += scan_file(files[i], options);
+    }
+    return total_errors;
+}
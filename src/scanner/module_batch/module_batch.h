@@ -0,0 +1,34 @@
+/*
+ * -----------------------------------------------------------------------------
+ * module_batch.h
+ *
+ * Batch scanning (-batch): many input files scanned at the same time on a
+ * pool of worker threads. Each worker has a queue of files; when it is empty
+ * it steals files from the other queues (work stealing), so a few big files
+ * do not leave the other workers idle.
+ *
+ * Each file is scanned with the scanner state of its worker thread (status,
+ * errors and counters are per thread), so every .cscn is the same as the one
+ * of a scan of that file alone.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef MODULE_BATCH_H
+#define MODULE_BATCH_H
+#include "../config.h"
+
+#define MAX_BATCH_WORKERS 64
+
+// Scans one file on the calling thread with the flags of options; returns its number of errors
+typedef int (*BatchScanFn)(const char* ifile_name, const Status* options);
+
+/**
+ * Scans files[0 .. num_files) with scan_file on num_workers threads
+ * (num_workers < 1: one per online processor). Returns the total number of errors.
+ */
+int scan_batch(char** files, int num_files, int num_workers, const Status* options, BatchScanFn scan_file);
+
+#endif // MODULE_BATCH_H
@@ -0,0 +1,35 @@
+# -----------------------------------------------------------------------------
+# src/scanner/module_cache/build_hash.cmake
+#
+# Writes the hash of the scanner sources (every .c, .h and .spec file under
+# src/scanner and their CMakeLists.txt) as SCANNER_BUILD_HASH, the version of
+# the -cache entries: any change to the driver, the tables or the output
+# format gives new keys, so an entry written by another build is never used.
+# The file is only rewritten when the hash changes.
+#
+# Variables: ROOT (src/scanner), OUTPUT (generated .c file)
+# -----------------------------------------------------------------------------
+
+file(GLOB_RECURSE sources RELATIVE "${ROOT}"
+    "${ROOT}/*.c" "${ROOT}/*.h" "${ROOT}/*.spec" "${ROOT}/*.cmake" "${ROOT}/CMakeLists.txt")
+list(SORT sources)
+
+# Name and contents of every file: a file moved or renamed also changes the hash
+set(manifest "")
+foreach(source IN LISTS sources)
+    file(SHA256 "${ROOT}/${source}" source_hash)
+    string(APPEND manifest "${source} ${source_hash}\n")
+endforeach()
+string(SHA256 digest "${manifest}")
+string(SUBSTRING "${digest}" 0 16 key)
+
+set(content "// Generated by build_hash.cmake from the scanner sources, do not edit\n")
+string(APPEND content "#include <stdint.h>\n\n")
+string(APPEND content "const uint64_t SCANNER_BUILD_HASH = 0x${key}ull;\n")
+
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" previous)
+endif()
+if(NOT previous STREQUAL content)
+    file(WRITE "${OUTPUT}" "${content}")
+endif()
@@ -0,0 +1,167 @@
+/*
+ * -----------------------------------------------------------------------------
+ * module_cache.c
+ *
+ * Cache of scanner outputs (see module_cache.h). The key is one pass over the
+ * input, 8 bytes per step (multiply and shift, not a cryptographic hash), so
+ * a hit costs the hash and the copy of the cached files, not the scan.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include "module_cache.h"
+#include "../count.h"
+#include <limits.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+    #include <direct.h>
+    #include <process.h>
+    #define cache_mkdir(dir) _mkdir(dir)
+    #define cache_pid() _getpid()
+#else
+    #include <unistd.h>
+    #define cache_mkdir(dir) mkdir((dir), 0755)
+    #define cache_pid() getpid()
+#endif
+
+#define CACHE_NAME_LEN (MAX_FILENAME + 64)  // cache_dir + "/" + key (16) + pid, pointer and extension
+#define CACHE_COPY_BLOCK (1 << 16)
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ull
+
+static uint64_t mix(uint64_t h) {       // Final de splitmix64: tots els bits depenen de tots
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+static uint64_t hash_bytes(const char* data, size_t len, uint64_t seed) {
+    uint64_t h = mix(seed ^ (uint64_t)len);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        h = (h ^ word) * HASH_MULTIPLIER;
+        h ^= h >> 32;
+    }
+    uint64_t last = 0;
+    memcpy(&last, data + i, len - i);
+    COUNT_GEN((int)(len / 8) + 1);
+    return mix(h ^ last);
+}
+
+uint64_t cache_key(void) {
+    return hash_bytes(status.input, (size_t)status.input_len, SCANNER_BUILD_HASH);
+}
+
+static void entry_name(char* name, uint64_t key, const char* extension) {
+    snprintf(name, CACHE_NAME_LEN, "%s/%016llx.%s", status.cache_dir, (unsigned long long)key, extension);
+}
+
+// Copies up to max bytes of in to out; false if a write fails
+static bool copy_stream(FILE* in, FILE* out, long max) {
+    char block[CACHE_COPY_BLOCK];
+    while (max > 0) {
+        size_t want = max < CACHE_COPY_BLOCK ? (size_t)max : CACHE_COPY_BLOCK;
+        size_t got = fread(block, 1, want, in);
+        COUNT_IO(1);
+        if (got == 0) {
+            break;
+        }
+        if (fwrite(block, 1, got, out) != got) {
+            return false;
+        }
+        max -= (long)got;
+    }
+    return !ferror(in);
+}
+
+// Whole file in memory (*size bytes), NULL if it cannot be read
+static char* read_entry(const char* name, long* size) {
+    FILE* f = fopen(name, "rb");
+    COUNT_COMP(1);
+    if (!f) {
+        return NULL;
+    }
+    char* data = NULL;
+    if (fseek(f, 0, SEEK_END) == 0 && (*size = ftell(f)) >= 0 && fseek(f, 0, SEEK_SET) == 0) {
+        data = malloc(*size > 0 ? (size_t)*size : 1);
+    }
+    if (data && fread(data, 1, (size_t)*size, f) != (size_t)*size) {
+        free(data);
+        data = NULL;
+    }
+    COUNT_IO(1);
+    fclose(f);
+    return data;
+}
+
+bool cache_lookup(uint64_t key) {
+    char name[CACHE_NAME_LEN];
+    long size;
+    entry_name(name, key, "cscn");
+    char* tokens = read_entry(name, &size);  // Sencer abans d'escriure: si falla, no s'ha escrit res
+    COUNT_COMP(1);
+    if (!tokens) {
+        return false;
+    }
+    COUNT_COMP(1);
+    if (status.binary_out) {
+        entry_name(name, key, "cscnb");
+        FILE* binary = fopen(name, "rb");
+        FILE* out = binary ? fopen(status.bfile_name, "wb") : NULL;
+        bool copied = out && copy_stream(binary, out, LONG_MAX);
+        if (out && fclose(out) != 0) {
+            copied = false;
+        }
+        if (binary) {
+            fclose(binary);
+        }
+        if (!copied) {  // El .cscnb es torna a escriure després de l'escaneig
+            free(tokens);
+            return false;
+        }
+    }
+    fwrite(tokens, 1, (size_t)size, status.ofile);
+    COUNT_IO(1);
+    free(tokens);
+    return true;
+}
+
+/**
+ * Copies the bytes [from, to) of the file src to the entry of key: first to a temporary file
+ * that is then renamed, so other scanners only see whole entries
+ */
+static void store_entry_file(uint64_t key, const char* extension, const char* src, long from, long to) {
+    char tmp_name[CACHE_NAME_LEN];
+    // Nom únic per procés i fil (status és de cada fil): dos workers poden guardar el mateix input
+    snprintf(tmp_name, CACHE_NAME_LEN, "%s/%016llx.%d.%p.tmp", status.cache_dir, (unsigned long long)key,
+             (int)cache_pid(), (void*)&status);
+    FILE* in = fopen(src, "rb");
+    FILE* out = in ? fopen(tmp_name, "wb") : NULL;
+    bool written = out && fseek(in, from, SEEK_SET) == 0 && copy_stream(in, out, to - from);
+    if (out && fclose(out) != 0) {
+        written = false;
+    }
+    if (in) {
+        fclose(in);
+    }
+    char name[CACHE_NAME_LEN];
+    entry_name(name, key, extension);
+    if (out && (!written || rename(tmp_name, name) != 0)) {
+        remove(tmp_name);
+    }
+}
+
+void cache_store(uint64_t key, long from, long to) {
+    cache_mkdir(status.cache_dir);  // Si ja hi és falla, i no passa res
+    COUNT_COMP(1);
+    if (status.binary_out) {        // Primer el binari: si hi ha el .cscn, el .cscnb ja hi és
+        store_entry_file(key, "cscnb", status.bfile_name, 0, LONG_MAX);
+    }
+    store_entry_file(key, "cscn", status.ofile_name, from, to);
+}
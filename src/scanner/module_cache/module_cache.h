@@ -0,0 +1,48 @@
+/*
+ * -----------------------------------------------------------------------------
+ * module_cache.h
+ *
+ * Cache of scanner outputs (-cache DIR). An input that was already scanned
+ * (same bytes, same tables, same output mode) is not scanned again: its
+ * tokens are copied from DIR into the .cscn (and the .cscnb with -binary).
+ *
+ * Every entry is two files named by the key (a 64-bit hash of the input bytes
+ * seeded with SCANNER_BUILD_HASH, the hash of the scanner sources at build
+ * time, so a change to the driver, the tables or the output format never
+ * reads the entries of another build):
+ *     DIR/<key>.cscn      The tokens as automata_driver wrote them
+ *     DIR/<key>.cscnb     The binary token file, if the scan had -binary
+ * Only scans without errors or warnings are stored: their messages have the
+ * file name and are not part of the tokens. Entries are written to a
+ * temporary file and renamed, so -batch workers (or several scanners) can
+ * share a directory. The cache is an optimization: when it cannot be read or
+ * written the file is just scanned.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#ifndef MODULE_CACHE_H
+#define MODULE_CACHE_H
+#include "../config.h"
+
+// Hash of the scanner sources (scanner_build_hash.c, generated by build_hash.cmake)
+extern const uint64_t SCANNER_BUILD_HASH;
+
+// Key of status.input for the entries of status.cache_dir
+uint64_t cache_key(void);
+
+/**
+ * Writes the cached tokens of key to status.ofile (and copies the binary to status.bfile_name
+ * with -binary). Returns false, without writing anything, if the entry is not in the cache.
+ */
+bool cache_lookup(uint64_t key);
+
+/**
+ * Stores the entry of key: the bytes [from, to) of status.ofile_name (the tokens) and, with
+ * -binary, status.bfile_name. The files have to be closed. Nothing is reported if it fails.
+ */
+void cache_store(uint64_t key, long from, long to);
+
+#endif // MODULE_CACHE_H
@@ -6,8 +6,10 @@
  * Tracks errors and warnings during scanning, prints them to stderr,
  * and provides a summary at the end.
  *
- * Error format:   ERROR: <filename>:<line>: <message>
- * Warning format: WARNING: <filename>:<line>: <message>
+ * Error format:   ERROR: <filename>:<line>[:<column>]: <message>
+ * Warning format: WARNING: <filename>:<line>[:<column>]: <message>
+ * Errors of a token only get its offset: line and column come from the
+ * newline index (status.lines), computed here and not while scanning.
  *
  * Team: GA
  * Contributor/s: Gorka Hernández Villalón
@@ -15,24 +17,52 @@
  */
 #include "module_error.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-// Internal state
-static ErrorEntry error_list[MAX_ERRORS];
-static int entry_count = 0;
-static int total_errors = 0;
-static int total_warnings = 0;
-extern Status status;
+// Internal state (per thread: each file scanned in -batch reports its own errors)
+// The entries are on the heap, allocated with the first error: a thread without errors
+// (most -batch workers, every -jobs chunk) only has the pointer and the counters
+static _Thread_local ErrorEntry* error_list = NULL;
+static _Thread_local int error_capacity = 0;
+static _Thread_local int entry_count = 0;
+static _Thread_local int total_errors = 0;
+static _Thread_local int total_warnings = 0;
+extern _Thread_local Status status;
 void error_init(void) {
-    entry_count = 0;
+    error_free();
     total_errors = 0;
     total_warnings = 0;
-    memset(error_list, 0, sizeof(error_list));
 }
-static void store_entry(const char* message, int line, Severity severity, Error error_type, Step step) {
-    if (entry_count < MAX_ERRORS) {
+void error_free(void) {
+    free(error_list);
+    error_list = NULL;
+    error_capacity = 0;
+    entry_count = 0;
+}
+// Room for one more entry (up to MAX_ERRORS); false if there is no room
+static bool reserve_entry(void) {
+    if (entry_count < error_capacity) {
+        return true;
+    }
+    if (error_capacity == MAX_ERRORS) {
+        return false;
+    }
+    int capacity = error_capacity ? error_capacity * 2 : MIN_ERRORS;
+    capacity = capacity < MAX_ERRORS ? capacity : MAX_ERRORS;
+    ErrorEntry* more = realloc(error_list, capacity * sizeof(ErrorEntry));
+    if (!more) {
+        return false;   // Només es perd el missatge guardat: el total i la sortida hi són igualment
+    }
+    error_list = more;
+    error_capacity = capacity;
+    return true;
+}
+static void store_entry(const char* message, int line, int column, Severity severity, Error error_type, Step step) {
+    if (reserve_entry()) {
         strncpy(error_list[entry_count].message, message, MAX_LINE_LENGTH - 1);
         error_list[entry_count].message[MAX_LINE_LENGTH - 1] = '\0';
         error_list[entry_count].line = line;
+        error_list[entry_count].column = column;
         error_list[entry_count].severity = severity;
         error_list[entry_count].error_type = error_type;
         error_list[entry_count].step = step;
@@ -47,23 +77,45 @@ static void store_entry(const char* message, int line, Severity severity, Error
         const char* prefix = (severity == SEVERITY_ERROR) ? "ERROR" : "WARNING";
         const char* step_str = step_to_string(step);
         const char* filename = (status.ifile_name[0] != '\0') ? status.ifile_name : "<unknown>";
-        fprintf(status.error_file, "[%s] %s: %s:%d: %s\n", step_str, prefix, filename, line, message);
+        FILE* out = status.error_file ? status.error_file : stderr; // Encara no hi ha fitxer de sortida (p.ex. no s'ha pogut obrir l'entrada)
+        if (column > 0) {
+            fprintf(out, "[%s] %s: %s:%d:%d: %s\n", step_str, prefix, filename, line, column, message);
+        } else {
+            fprintf(out, "[%s] %s: %s:%d: %s\n", step_str, prefix, filename, line, message);
+        }
     }
 }
 void report_error(const char* message, int line, Step step) {
-    store_entry(message, line, SEVERITY_ERROR, ERR_NONE, step);
+    store_entry(message, line, 0, SEVERITY_ERROR, ERR_NONE, step);
 }
 void report_warning(const char* message, int line, Step step) {
-    store_entry(message, line, SEVERITY_WARNING, ERR_NONE, step);
+    store_entry(message, line, 0, SEVERITY_WARNING, ERR_NONE, step);
+}
+void report_warning_at(const char* message, int line, int column, Step step) {
+    store_entry(message, line, column, SEVERITY_WARNING, ERR_NONE, step);
 }
-void report_error_token(const Token* token, int line, Step step) {
+void report_error_token(const Token* token, Step step) {
+    Error error_type = token->error != ERR_NONE ? token->error : ERR_TOKEN_NOT_RECOGNIZED;
+    const char* what = error_type == ERR_UNTERMINATED_LITERAL ? "Unterminated literal"
+                     : error_type == ERR_TOKEN_TOO_LONG ? "Token too long"
+                     : "Non-recognized token";
+    int shown = token->len < MAX_SHOWN_LEXEME ? token->len : MAX_SHOWN_LEXEME; // Un token fugit pot ser molt llarg
+    while (shown > 0 && shown < token->len && ((unsigned char)status.input[token->offset + shown] & 0xC0) == 0x80) {
+        shown--;    // No es talla un caràcter UTF-8 per la meitat
+    }
     char msg[MAX_LINE_LENGTH];
-    snprintf(msg, sizeof(msg), "Non-recognized token '%s'", token->lexeme);
-    store_entry(msg, line, SEVERITY_ERROR, ERR_TOKEN_NOT_RECOGNIZED, step);
+    if (error_type == ERR_NUL_BYTE) { // %.*s s'aturaria al '\0'
+        snprintf(msg, sizeof(msg), "NUL byte '\\0' in the input");
+    } else {
+        snprintf(msg, sizeof(msg), "%s '%.*s%s'", what, shown, status.input + token->offset,
+                 shown < token->len ? "..." : "");
+    }
+    store_entry(msg, line_of_offset(&status.lines, token->offset), column_of_offset(&status.lines, status.input, token->offset),
+                SEVERITY_ERROR, error_type, step);
 }
 void report_error_typed(Error error_type, int line, Step step) {
     const char* msg = error_type_to_string(error_type);
-    store_entry(msg, line, SEVERITY_ERROR, error_type, step);
+    store_entry(msg, line, 0, SEVERITY_ERROR, error_type, step);
 }
 int error_count(void) {
     return total_errors;
@@ -72,23 +124,25 @@ int warning_count(void) {
     return total_warnings;
 }
 void error_finalize(void) {
+    error_free();
     if (status.oform == DEBUG) {
-        fprintf(status.error_file, "\n--- Scanner Summary ---\n");
-        fprintf(status.error_file, "Total errors:   %d\n", total_errors);
-        fprintf(status.error_file, "Total warnings: %d\n", total_warnings);
+        FILE* out = status.error_file ? status.error_file : stderr;
+        fprintf(out, "\n--- Scanner Summary ---\n");
+        fprintf(out, "Total errors:   %d\n", total_errors);
+        fprintf(out, "Total warnings: %d\n", total_warnings);
         if (total_errors == 0 && total_warnings == 0) {
-            fprintf(status.error_file, "Scanning completed successfully.\n");
+            fprintf(out, "Scanning completed successfully.\n");
         } else {
-            fprintf(status.error_file, "Scanning completed with issues.\n");
+            fprintf(out, "Scanning completed with issues.\n");
         }
-        fprintf(status.error_file, "---\n");
+        fprintf(out, "---\n");
     }
 }
 void print_all_errors(void) {
     fprintf(stderr, "\n--- Error Type Catalog ---\n");
     fprintf(stderr, "%-6s  %-30s  %s\n", "Code", "Enum", "String");
     fprintf(stderr, "%-6s  %-30s  %s\n", "----", "----", "------");
-    for (int i = ERR_NONE; i <= ERR_EMPTY_FILE; i++) {
+    for (int i = ERR_NONE; i <= ERR_NUL_BYTE; i++) {
         const char* name;
         switch (i) {
             case ERR_NONE:                 name = "ERR_NONE"; break;
@@ -99,6 +153,7 @@ void print_all_errors(void) {
             case ERR_UNTERMINATED_LITERAL:  name = "ERR_UNTERMINATED_LITERAL"; break;
             case ERR_MAX_TOKENS_EXCEEDED:  name = "ERR_MAX_TOKENS_EXCEEDED"; break;
             case ERR_EMPTY_FILE:           name = "ERR_EMPTY_FILE"; break;
+            case ERR_NUL_BYTE:             name = "ERR_NUL_BYTE"; break;
             default:                       name = "UNKNOWN"; break;
         }
         fprintf(stderr, "%-6d  %-30s  %s\n", i, name, error_type_to_string((Error)i));
@@ -122,6 +177,7 @@ const char* error_type_to_string(Error err) {
         case ERR_UNTERMINATED_LITERAL: return "UNTERMINATED_LITERAL";
         case ERR_MAX_TOKENS_EXCEEDED: return "MAX_TOKENS_EXCEEDED";
         case ERR_EMPTY_FILE:          return "EMPTY_FILE";
+        case ERR_NUL_BYTE:            return "NUL_BYTE";
         default:                      return "UNKNOWN_ERROR";
     }
 }
\ No newline at end of file
@@ -22,6 +22,10 @@
 #include "../config.h"
 // Maximum number of error/warning entries stored
 #define MAX_ERRORS 256
+// Entries allocated with the first error (the array doubles up to MAX_ERRORS)
+#define MIN_ERRORS 8
+// Characters of the lexeme shown in a token error
+#define MAX_SHOWN_LEXEME 40
 // Error severity levels
 typedef enum {
     SEVERITY_WARNING,
@@ -31,14 +35,19 @@ typedef enum {
 typedef struct {
     char message[MAX_LINE_LENGTH];
     int line;
+    int column;         // 0 = unknown
     Severity severity;
     Error error_type;
     Step step;
 } ErrorEntry;
 void error_init(void);
+// Frees the stored entries (error_finalize does it too); the totals are kept
+void error_free(void);
 void report_error(const char* message, int line, Step step);
 void report_warning(const char* message, int line, Step step);
-void report_error_token(const Token* token, int line, Step step);
+void report_warning_at(const char* message, int line, int column, Step step);
+// Error of a token (token->error, or non-recognized); position (line:column) from its offset
+void report_error_token(const Token* token, Step step);
 void report_error_typed(Error error_type, int line, Step step);
 int error_count(void);
 int warning_count(void);
@@ -16,6 +16,13 @@
  * Supported Flags:
  * - -help: Display usage information
  * - -errors: Display error type codes and descriptions
+ * - -lockstep: Run every automaton on its own (reference engine)
+ * - -binary: Also write the binary token file (<input>scnb)
+ * - -jobs N: Scan the input in N chunks at the same time (same output)
+ * - -batch: Scan every input file given, -jobs N files at the same time
+ * - -countlog: Write every operation count increment (DEBUG), not only the totals
+ * - -counttsv FILE: Append the counts (per function and total) to FILE as TSV
+ * - -cache DIR: Copy the outputs of an earlier scan of the same bytes from DIR
  *
  * Team: GA
  * Contributor/s: Pol García
@@ -24,9 +31,11 @@
 
 #include "../config.h"
 #include "../module_error/module_error.h"
+#include "../module_automata/module_automata.h"
 #include "../count.h"
 
 int init_status_scn(void);
+int init_file_scn(const char* ifile_name);
 
 void print_arguments(int argc, char *argv[]) {
     fprintf(status.ofile, "Arguments received (%d):\n", argc);
@@ -39,11 +48,21 @@ void print_arguments(int argc, char *argv[]) {
 void show_help(void) { // not finished
     printf("Flags you can use:\n");
     printf("  -help    Display this help message\n");
-    printf("  -errors  Display all error types and their codes\n\n");
+    printf("  -errors  Display all error types and their codes\n");
+    printf("  -lockstep  Step every automaton on its own instead of the combined DFA\n");
+    printf("  -vector  Step every automaton at once in vector lanes (AVX2 if available)\n");
+    printf("  -binary  Also write the tokens in binary (<input>scnb) for the parser\n");
+    printf("  -jobs N  Scan the input in N chunks with N threads (not with -countlog)\n");
+    printf("  -batch   Scan all the input files given, -jobs N of them at the same time\n");
+    printf("  -countlog  Write a [COUNT] line for every counted operation (DEBUG, slow)\n");
+    printf("  -counttsv FILE  Append the operation counts to FILE as TSV (count baselines)\n");
+    printf("  -cache DIR  Reuse the outputs of an earlier scan of the same input bytes (stored in DIR)\n\n");
 }
 
 
 int init_program(int argc, char* argv[]){
+    status.batch_files = malloc(argc * sizeof(char*)); // Fitxers d'entrada de -batch (com a molt tots els arguments)
+    status.num_batch_files = 0;
     for (int i = 1; i < argc; i++) {
 
         if (strcmp(argv[i], HELP_F) == 0) { //If  we want to show the help manpage
@@ -52,8 +71,27 @@ int init_program(int argc, char* argv[]){
         } else if (strcmp(argv[i], ERRORS_F) == 0) {
             print_all_errors();
             return HELP_RETURN;
+        } else if (strcmp(argv[i], LOCKSTEP_F) == 0) {
+            status.engine = ENGINE_LOCKSTEP;
+        } else if (strcmp(argv[i], VECTOR_F) == 0) {
+            status.engine = ENGINE_VECTOR;
+        } else if (strcmp(argv[i], BINARY_F) == 0) {
+            status.binary_out = true;
+        } else if (strcmp(argv[i], JOBS_F) == 0 && i + 1 < argc) {
+            status.jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], COUNTLOG_F) == 0) {
+            status.count_log = true;
+        } else if (strcmp(argv[i], COUNTTSV_F) == 0 && i + 1 < argc) {
+            strncpy(status.count_tsv, argv[++i], MAX_FILENAME - 1);
+        } else if (strcmp(argv[i], CACHE_F) == 0 && i + 1 < argc) {
+            strncpy(status.cache_dir, argv[++i], MAX_FILENAME - 1);
+        } else if (strcmp(argv[i], BATCH_F) == 0) {
+            status.batch = true;
         } else if (argv[i][0] != '-') {
             strncpy(status.ifile_name, argv[i], MAX_FILENAME - 1);
+            if (status.batch_files) {
+                status.batch_files[status.num_batch_files++] = argv[i];
+            }
         } // We assume if it is not "-"" it is not any flag but the input_file. In case this changes we would change this part
         else {
             char msg[256];
@@ -65,14 +103,57 @@ int init_program(int argc, char* argv[]){
         report_error_typed(ERR_INVALID_ARGUMENT, 0, SCANNER_STEP);
         return ERROR_RETURN;
     }
+    if (status.batch) { // Cada worker obre els seus fitxers amb init_file_scn
+        return status.batch_files ? BATCH_RETURN : ERROR_RETURN;
+    }
 
-    int status_result = init_status_scn();
+    return init_file_scn(status.ifile_name);
+}
 
-    COUNT_INIT();
+/**
+ * Obre un fitxer d'entrada i prepara status per escanejar-lo (també el comptatge)
+ * Amb -batch es crida per cada fitxer, al fil del worker que l'escaneja
+ */
+int init_file_scn(const char* ifile_name){
+    if (ifile_name != status.ifile_name) {
+        strncpy(status.ifile_name, ifile_name, MAX_FILENAME - 1);
+    }
+    int status_result = init_status_scn();
 
     if (status_result != CORRECT_RETURN) {
         return ERROR_RETURN;
     }
+    COUNT_INIT(); // Només si el fitxer s'ha obert (amb -batch el mateix fil en comptarà més)
+    return CORRECT_RETURN;
+}
+
+/**
+ * Llegeix tot el fitxer d'entrada a status.input (acabat en '\0'), així el scanner
+ * treballa sobre un buffer en memòria i no fa cap crida de stdio per caràcter
+ */
+static int read_input_file(FILE* ifile){
+    int capacity = 1 << 16;
+    int len = 0;
+    char* input = malloc(capacity);
+    while (input) {
+        len += (int)fread(input + len, 1, capacity - len - 1, ifile);
+        if (len < capacity - 1) {
+            break;  // EOF (o error de lectura)
+        }
+        capacity *= 2;
+        char* bigger = realloc(input, capacity);
+        if (!bigger) {
+            free(input);
+        }
+        input = bigger;
+    }
+    if (!input || ferror(ifile)) {
+        free(input);
+        return ERROR_RETURN;
+    }
+    input[len] = '\0';
+    status.input = input;
+    status.input_len = len;
     return CORRECT_RETURN;
 }
 
@@ -80,20 +161,32 @@ int init_status_scn(){
     status.oform = OUTFORMAT_M;
     status.debug = DEBUG_F;
     
-    snprintf(status.ofile_name, MAX_FILENAME, "%sscn", status.ifile_name);
-
     status.ifile_name[MAX_FILENAME - 1] = '\0';
-    status.ofile_name[MAX_FILENAME - 1] = '\0';
+    // Les sortides afegeixen "scn" / "scnb" al nom: si no hi caben s'escriuria un altre fitxer
+    int ofile_len = snprintf(status.ofile_name, MAX_FILENAME, "%sscn", status.ifile_name);
+    int bfile_len = snprintf(status.bfile_name, MAX_FILENAME, "%sscnb", status.ifile_name);
+    if (ofile_len < 0 || ofile_len >= MAX_FILENAME || bfile_len < 0 || bfile_len >= MAX_FILENAME) {
+        report_error("Input file name too long for the output file names", 0, SCANNER_STEP);
+        return ERROR_RETURN;
+    }
 
     status.ifile = fopen(status.ifile_name, "r");
     if (!status.ifile) {
         report_error_typed(ERR_FILE_NOT_FOUND, 0, SCANNER_STEP);
         return ERROR_RETURN;
     }
+    if (read_input_file(status.ifile) != CORRECT_RETURN) {
+        fclose(status.ifile);
+        status.ifile = NULL;
+        report_error("Could not read the input file", 0, SCANNER_STEP);
+        return ERROR_RETURN;
+    }
     status.ofile = fopen(status.ofile_name, "w");
     if (!status.ofile) {
         if (status.ifile) fclose(status.ifile);
         status.ifile = NULL;
+        free(status.input);
+        status.input = NULL;
         report_error_typed(ERR_FILE_NOT_FOUND, 0, SCANNER_STEP);
         return ERROR_RETURN;
     }
@@ -112,11 +205,7 @@ int init_status_scn(){
 }
 
 void init_automata(AutomataList* automata_list){
-    automata_list->num_automata = NUM_AUTOMATA;
-    for(int i = 0; i < NUM_AUTOMATA; i++){
-        automata_list->automatas[i] = ALL_AUTOMATA[i];
-    }
-    COUNT_GEN(NUM_AUTOMATA);
+    init_automata_list(automata_list, status.engine);   // L'engine dels flags
 }
 
 // FILE* set_output_test_file(const char* filename);
\ No newline at end of file
@@ -41,5 +41,6 @@
 int init_status_scn(void);
 void init_automata(AutomataList* automata_list);
 int init_program(int argc, char* argv[]);
+int init_file_scn(const char* ifile_name);
 void show_help(void);
 #endif // MODULE_INIT_H
\ No newline at end of file
@@ -0,0 +1,1125 @@
+/*
+ * -----------------------------------------------------------------------------
+ * tablegen.c
+ *
+ * Build-time generator of the scanner automata tables.
+ * Reads the token specification (tokens.spec: category, priority, regex) and
+ * writes a C source file with:
+ * - CLASS_OF: byte -> symbol class shared by every table
+ * - One minimized AutomataDFA per rule (ALL_AUTOMATA, ordered by priority)
+ * - FIRST_BYTE_AUTOMATA: byte -> bitmask of the rules that can start a token
+ *   with it (bit i = ALL_AUTOMATA[i]), so the lockstep engine only steps those
+ * - VECTOR_AUTOMATA: the same rule automata interleaved lane by lane
+ *   ([class][state][lane]), so the vector engine gathers every next state of a
+ *   byte in one step
+ * - COMBINED_AUTOMATA: one minimized DFA for all the rules together; each
+ *   accepting state keeps the category of the highest priority rule, and the
+ *   run states (self loop on all but a few stop bytes) and the pending
+ *   category of every state (rule still possible) are marked
+ * - RESERVED_WORDS: perfect hash table of the reserved words ("words" lines),
+ *   used to reclassify IDENTIFIER lexemes as KEYWORD, TYPE...
+ *
+ * Pipeline: regex -> Thompson NFA -> subset construction (over byte classes)
+ *           -> Hopcroft minimization -> C tables
+ *           words -> seed search until no two words share a slot -> C table
+ *
+ * Usage: scanner_tablegen <tokens.spec> <output.c>
+ * It is run by CMake (add_custom_command in module_automata), never by hand.
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+
+#define MAX_RULES 64
+#define MAX_REGEX 1024
+#define MAX_NAME 64
+#define MAX_NFA_NODES 8192
+#define MAX_DFA_STATES 4096
+#define MAX_RULE_STATES 255     // AutomataDFA rows are uint8_t
+#define MAX_WORDS 512
+#define MAX_RUN_STOPS 3         // = MAX_RUN_STOPS in config.h
+#define VECTOR_LANES 8          // = VECTOR_LANES in config.h
+#define VECTOR_ACCEPT 0x100     // = VECTOR_ACCEPT in config.h
+#define MAX_SEED 1000000
+#define IDENTIFIER_CATEGORY "IDENTIFIER"    // Rule whose lexemes are looked up in RESERVED_WORDS
+
+typedef struct ByteSet {
+    uint32_t w[8];
+} ByteSet;
+
+typedef struct NfaNode {
+    ByteSet set;        // Bytes of the char edge (empty if the node only has epsilon edges)
+    int target;         // Target of the char edge
+    int eps[2];         // Epsilon edges (-1 = none)
+} NfaNode;
+
+typedef struct Fragment {
+    int start;
+    int out;            // Single exit node, without edges while it is the exit
+} Fragment;
+
+typedef struct Rule {
+    char category[MAX_NAME];
+    int priority;
+    int order;              // Line order, breaks priority ties
+    char regex[MAX_REGEX];
+    Fragment frag;
+} Rule;
+
+typedef struct Word {
+    char text[MAX_NAME];
+    char category[MAX_NAME];
+} Word;
+
+typedef struct Dfa {
+    int num_states;         // State 0 = dead, state 1 = start
+    int num_classes;
+    int *next;              // [state][class]
+    int *tag;               // [state] -> accepted rule index, or -1
+} Dfa;
+
+static NfaNode nfa[MAX_NFA_NODES];
+static int num_nodes = 0;
+
+static Rule rules[MAX_RULES];
+static int num_rules = 0;
+
+static Word words[MAX_WORDS];
+static int num_words = 0;
+
+static int class_of[256];
+static int num_classes = 0;
+
+static const char *spec_name;
+static int spec_line;
+static const char *re_pos;     // Cursor of the regex being parsed
+
+static void fail(const char *message){
+    fprintf(stderr, "%s:%d: %s\n", spec_name, spec_line, message);
+    exit(EXIT_FAILURE);
+}
+
+//BYTE SETS
+
+static void set_add(ByteSet *s, int b){
+    s->w[b >> 5] |= 1u << (b & 31);
+}
+
+static bool set_has(const ByteSet *s, int b){
+    return (s->w[b >> 5] >> (b & 31)) & 1u;
+}
+
+static bool set_empty(const ByteSet *s){
+    for (int i = 0; i < 8; i++){
+        if (s->w[i] != 0){
+            return false;
+        }
+    }
+    return true;
+}
+
+static void set_invert(ByteSet *s){
+    for (int i = 0; i < 8; i++){
+        s->w[i] = ~s->w[i];
+    }
+}
+
+//THOMPSON CONSTRUCTION
+
+static int new_node(void){
+    if (num_nodes >= MAX_NFA_NODES){
+        fail("regex too big (MAX_NFA_NODES)");
+    }
+    memset(&nfa[num_nodes].set, 0, sizeof(ByteSet));
+    nfa[num_nodes].target = -1;
+    nfa[num_nodes].eps[0] = -1;
+    nfa[num_nodes].eps[1] = -1;
+    return num_nodes++;
+}
+
+static void add_eps(int from, int to){
+    int i = nfa[from].eps[0] == -1 ? 0 : 1;
+    nfa[from].eps[i] = to;
+}
+
+static Fragment frag_set(const ByteSet *s){
+    Fragment f = { new_node(), new_node() };
+    nfa[f.start].set = *s;
+    nfa[f.start].target = f.out;
+    return f;
+}
+
+static Fragment frag_empty(void){
+    int n = new_node();
+    Fragment f = { n, n };
+    return f;
+}
+
+static Fragment frag_concat(Fragment a, Fragment b){
+    add_eps(a.out, b.start);
+    Fragment f = { a.start, b.out };
+    return f;
+}
+
+static Fragment frag_alt(Fragment a, Fragment b){
+    Fragment f = { new_node(), new_node() };
+    add_eps(f.start, a.start);
+    add_eps(f.start, b.start);
+    add_eps(a.out, f.out);
+    add_eps(b.out, f.out);
+    return f;
+}
+
+static Fragment frag_star(Fragment a){
+    Fragment f = { new_node(), new_node() };
+    add_eps(f.start, a.start);
+    add_eps(f.start, f.out);
+    add_eps(a.out, a.start);
+    add_eps(a.out, f.out);
+    return f;
+}
+
+static Fragment frag_plus(Fragment a){
+    int out = new_node();
+    add_eps(a.out, a.start);
+    add_eps(a.out, out);
+    Fragment f = { a.start, out };
+    return f;
+}
+
+static Fragment frag_opt(Fragment a){
+    Fragment f = { new_node(), a.out };
+    add_eps(f.start, a.start);
+    add_eps(f.start, a.out);
+    return f;
+}
+
+//REGEX PARSER
+// alt := concat ('|' concat)*     concat := repeat*     repeat := atom ('*' | '+' | '?')*
+// atom := '(' alt ')' | '[' ['^'] class ']' | '.' | '\' escape | char
+
+static int hex_value(char c){
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    fail("bad hex digit in \\x escape");
+    return 0;
+}
+
+// Reads one (possibly escaped) byte at re_pos
+static int parse_byte(void){
+    if (*re_pos == '\0'){
+        fail("unexpected end of regex");
+    }
+    if (*re_pos != '\\'){
+        return (unsigned char)*re_pos++;
+    }
+    re_pos++;
+    char c = *re_pos++;
+    switch (c){
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case 's': return ' ';
+        case '0': return '\0';
+        case 'x': {
+            int hi = hex_value(*re_pos++);
+            int lo = hex_value(*re_pos++);
+            return hi * 16 + lo;
+        }
+        case '\0': fail("regex ends with a backslash"); return 0;
+        default: return (unsigned char)c; // \\ \| \( \[ \. ... stand for themselves
+    }
+}
+
+static Fragment parse_alt(void);
+
+static Fragment parse_class(void){
+    ByteSet s = {0};
+    bool negated = false;
+    if (*re_pos == '^'){
+        negated = true;
+        re_pos++;
+    }
+    bool first = true;
+    while (*re_pos != ']' || first){
+        int lo = parse_byte();
+        int hi = lo;
+        if (re_pos[0] == '-' && re_pos[1] != ']' && re_pos[1] != '\0'){
+            re_pos++;
+            hi = parse_byte();
+        }
+        if (hi < lo){
+            fail("bad range in character class");
+        }
+        for (int b = lo; b <= hi; b++){
+            set_add(&s, b);
+        }
+        first = false;
+    }
+    re_pos++; // ']'
+    if (negated){
+        set_invert(&s);
+    }
+    return frag_set(&s);
+}
+
+static Fragment parse_atom(void){
+    ByteSet s = {0};
+    char c = *re_pos;
+    if (c == '('){
+        re_pos++;
+        Fragment f = parse_alt();
+        if (*re_pos != ')'){
+            fail("missing ')'");
+        }
+        re_pos++;
+        return f;
+    }
+    if (c == '['){
+        re_pos++;
+        return parse_class();
+    }
+    if (c == '.'){
+        re_pos++;
+        set_invert(&s);
+        s.w['\n' >> 5] &= ~(1u << ('\n' & 31));
+        return frag_set(&s);
+    }
+    if (c == '*' || c == '+' || c == '?' || c == ')' || c == ']'){
+        fail("unexpected operator in regex");
+    }
+    set_add(&s, parse_byte());
+    return frag_set(&s);
+}
+
+static Fragment parse_repeat(void){
+    Fragment f = parse_atom();
+    while (*re_pos == '*' || *re_pos == '+' || *re_pos == '?'){
+        char op = *re_pos++;
+        if (op == '*') f = frag_star(f);
+        else if (op == '+') f = frag_plus(f);
+        else f = frag_opt(f);
+    }
+    return f;
+}
+
+static Fragment parse_concat(void){
+    Fragment f = frag_empty();
+    while (*re_pos != '\0' && *re_pos != '|' && *re_pos != ')'){
+        f = frag_concat(f, parse_repeat());
+    }
+    return f;
+}
+
+static Fragment parse_alt(void){
+    Fragment f = parse_concat();
+    while (*re_pos == '|'){
+        re_pos++;
+        f = frag_alt(f, parse_concat());
+    }
+    return f;
+}
+
+//SPEC FILE
+
+static int compare_rules(const void *a, const void *b){
+    const Rule *ra = a;
+    const Rule *rb = b;
+    if (ra->priority != rb->priority){
+        return ra->priority - rb->priority;
+    }
+    return ra->order - rb->order;
+}
+
+// "CATEGORY words w1 w2 ...": reserved words, recognized by the IDENTIFIER rule
+static void read_words(const char *category, char *list){
+    for (char *w = strtok(list, " \t"); w != NULL; w = strtok(NULL, " \t")){
+        if (num_words >= MAX_WORDS){
+            fail("too many reserved words (MAX_WORDS)");
+        }
+        if (strlen(w) >= MAX_NAME){
+            fail("reserved word too long");
+        }
+        for (int i = 0; i < num_words; i++){
+            if (strcmp(words[i].text, w) == 0){
+                fail("reserved word listed twice");
+            }
+        }
+        strcpy(words[num_words].text, w);
+        strcpy(words[num_words].category, category);
+        num_words++;
+    }
+}
+
+// Line format: CATEGORY PRIORITY REGEX  or  CATEGORY words w1 w2 ...   (# starts a comment line)
+static void read_spec(const char *filename){
+    FILE *f = fopen(filename, "r");
+    if (!f){
+        fprintf(stderr, "scanner_tablegen: cannot open %s\n", filename);
+        exit(EXIT_FAILURE);
+    }
+    char line[MAX_REGEX + 2 * MAX_NAME];
+    spec_line = 0;
+    while (fgets(line, sizeof(line), f)){
+        spec_line++;
+        size_t len = strlen(line);
+        while (len > 0 && isspace((unsigned char)line[len - 1])){
+            line[--len] = '\0';
+        }
+        char *p = line;
+        while (isspace((unsigned char)*p)){
+            p++;
+        }
+        if (*p == '\0' || *p == '#'){
+            continue;
+        }
+        char category[MAX_NAME];
+        char kind[MAX_NAME];
+        int consumed = 0;
+        if (sscanf(p, "%63s %63s %n", category, kind, &consumed) == 2 && strcmp(kind, "words") == 0){
+            read_words(category, p + consumed);
+            continue;
+        }
+        if (num_rules >= MAX_RULES){
+            fail("too many rules (MAX_RULES)");
+        }
+        Rule *r = &rules[num_rules];
+        if (sscanf(p, "%63s %d %n", r->category, &r->priority, &consumed) != 2 || p[consumed] == '\0'){
+            fail("expected: CATEGORY PRIORITY REGEX");
+        }
+        for (int i = 0; i < num_rules; i++){
+            if (strcmp(rules[i].category, r->category) == 0){
+                fail("category already has a rule (use | inside one regex)");
+            }
+        }
+        strncpy(r->regex, p + consumed, MAX_REGEX - 1);
+        r->order = num_rules;
+
+        re_pos = r->regex;
+        r->frag = parse_alt();
+        if (*re_pos != '\0'){
+            fail("unbalanced ')' in regex");
+        }
+        num_rules++;
+    }
+    fclose(f);
+    if (num_rules == 0){
+        fail("no rules in the spec");
+    }
+    qsort(rules, num_rules, sizeof(Rule), compare_rules);
+}
+
+//BYTE CLASSES: bytes that no char edge tells apart share one class
+
+static void compute_classes(void){
+    int key_class[256];
+    for (int b = 0; b < 256; b++){
+        class_of[b] = 0;
+    }
+    num_classes = 1;
+    for (int n = 0; n < num_nodes; n++){
+        if (set_empty(&nfa[n].set)){
+            continue;
+        }
+        // Split every class in (bytes in the set, bytes not in the set)
+        int split[256][2];
+        for (int c = 0; c < num_classes; c++){
+            split[c][0] = split[c][1] = -1;
+        }
+        int count = 0;
+        for (int b = 0; b < 256; b++){
+            int in = set_has(&nfa[n].set, b);
+            if (split[class_of[b]][in] == -1){
+                split[class_of[b]][in] = count++;
+            }
+            key_class[b] = split[class_of[b]][in];
+        }
+        memcpy(class_of, key_class, sizeof(class_of));
+        num_classes = count;
+    }
+}
+
+//SUBSET CONSTRUCTION
+
+typedef struct Subsets {
+    int words;          // uint64_t words per subset
+    int count;
+    uint64_t *bits;     // [count][words]
+} Subsets;
+
+static void closure(uint64_t *set, int *stack){
+    int top = 0;
+    for (int n = 0; n < num_nodes; n++){
+        if ((set[n >> 6] >> (n & 63)) & 1u){
+            stack[top++] = n;
+        }
+    }
+    while (top > 0){
+        int n = stack[--top];
+        for (int i = 0; i < 2; i++){
+            int t = nfa[n].eps[i];
+            if (t != -1 && !((set[t >> 6] >> (t & 63)) & 1u)){
+                set[t >> 6] |= (uint64_t)1 << (t & 63);
+                stack[top++] = t;
+            }
+        }
+    }
+}
+
+static int find_or_add(Subsets *sub, const uint64_t *set){
+    for (int q = 0; q < sub->count; q++){
+        if (memcmp(&sub->bits[(size_t)q * sub->words], set, sub->words * sizeof(uint64_t)) == 0){
+            return q;
+        }
+    }
+    if (sub->count >= MAX_DFA_STATES){
+        fail("DFA too big (MAX_DFA_STATES)");
+    }
+    memcpy(&sub->bits[(size_t)sub->count * sub->words], set, sub->words * sizeof(uint64_t));
+    return sub->count++;
+}
+
+/**
+ * Subset construction from the given rules (all of them for the combined DFA)
+ * The accepting tag of a state is the first rule (highest priority) whose exit is in it
+ */
+static Dfa build_dfa(const int *rule_ids, int count){
+    int words = (num_nodes + 63) / 64;
+    Subsets sub = { words, 0, calloc((size_t)MAX_DFA_STATES * words, sizeof(uint64_t)) };
+    uint64_t *set = calloc(words, sizeof(uint64_t));
+    int *stack = malloc(num_nodes * sizeof(int));
+    int representative[256];
+    for (int b = 255; b >= 0; b--){
+        representative[class_of[b]] = b;
+    }
+
+    Dfa dfa = { 0, num_classes, malloc((size_t)MAX_DFA_STATES * num_classes * sizeof(int)),
+                malloc(MAX_DFA_STATES * sizeof(int)) };
+
+    find_or_add(&sub, set);     // 0: empty subset (dead state)
+    for (int i = 0; i < count; i++){
+        int n = rules[rule_ids[i]].frag.start;
+        set[n >> 6] |= (uint64_t)1 << (n & 63);
+    }
+    closure(set, stack);
+    find_or_add(&sub, set);     // 1: start state
+
+    for (int q = 0; q < sub.count; q++){
+        const uint64_t *from = &sub.bits[(size_t)q * words];
+        dfa.tag[q] = -1;
+        for (int i = 0; i < count && dfa.tag[q] == -1; i++){
+            int out = rules[rule_ids[i]].frag.out;
+            if ((from[out >> 6] >> (out & 63)) & 1u){
+                dfa.tag[q] = rule_ids[i];
+            }
+        }
+        for (int c = 0; c < num_classes; c++){
+            memset(set, 0, words * sizeof(uint64_t));
+            for (int n = 0; n < num_nodes; n++){
+                if (((from[n >> 6] >> (n & 63)) & 1u) && set_has(&nfa[n].set, representative[c])){
+                    int t = nfa[n].target;
+                    set[t >> 6] |= (uint64_t)1 << (t & 63);
+                }
+            }
+            closure(set, stack);
+            dfa.next[q * num_classes + c] = find_or_add(&sub, set);
+        }
+    }
+    dfa.num_states = sub.count;
+    free(sub.bits);
+    free(set);
+    free(stack);
+    return dfa;
+}
+
+//HOPCROFT MINIMIZATION
+
+/**
+ * Hopcroft partition refinement; the result is renumbered so the dead block is 0,
+ * the start block is 1 and the rest follow in breadth first order from the start.
+ */
+static Dfa minimize(const Dfa *dfa){
+    int n = dfa->num_states;
+    int nc = dfa->num_classes;
+    int *block = malloc(n * sizeof(int));
+    int *size = calloc(n, sizeof(int));
+    bool *in_work = calloc(n, sizeof(bool));
+    int *work = malloc(n * sizeof(int));
+    bool *in_splitter = malloc(n * sizeof(bool));
+    bool *in_x = malloc(n * sizeof(bool));
+    int *count_x = malloc(n * sizeof(int));
+    int *new_block = malloc(n * sizeof(int));
+    int num_blocks = 0;
+    int num_work = 0;
+
+    // Initial partition: one block per accepting tag (-1 = not accepting)
+    int tag_block[MAX_RULES + 1];
+    for (int t = 0; t <= MAX_RULES; t++){
+        tag_block[t] = -1;
+    }
+    for (int q = 0; q < n; q++){
+        int t = dfa->tag[q] + 1;
+        if (tag_block[t] == -1){
+            tag_block[t] = num_blocks++;
+        }
+        block[q] = tag_block[t];
+        size[block[q]]++;
+    }
+    for (int b = 0; b < num_blocks; b++){
+        work[num_work++] = b;
+        in_work[b] = true;
+    }
+
+    while (num_work > 0){
+        int splitter = work[--num_work];
+        in_work[splitter] = false;
+        for (int q = 0; q < n; q++){
+            in_splitter[q] = block[q] == splitter;
+        }
+        for (int c = 0; c < nc; c++){
+            // X = states that go into the splitter with class c
+            for (int b = 0; b < num_blocks; b++){
+                count_x[b] = 0;
+                new_block[b] = -1;
+            }
+            for (int q = 0; q < n; q++){
+                in_x[q] = in_splitter[dfa->next[q * nc + c]];
+                if (in_x[q]){
+                    count_x[block[q]]++;
+                }
+            }
+            int blocks_before = num_blocks;
+            for (int b = 0; b < blocks_before; b++){
+                if (count_x[b] != 0 && count_x[b] != size[b]){
+                    new_block[b] = num_blocks++;
+                }
+            }
+            for (int q = 0; q < n; q++){
+                int b = block[q];
+                if (b < blocks_before && new_block[b] != -1 && in_x[q]){
+                    block[q] = new_block[b];
+                    size[b]--;
+                    size[new_block[b]]++;
+                }
+            }
+            for (int b = 0; b < blocks_before; b++){
+                int nb = new_block[b];
+                if (nb == -1){
+                    continue;
+                }
+                if (in_work[b]){
+                    work[num_work++] = nb;
+                    in_work[nb] = true;
+                } else {
+                    int smaller = size[nb] <= size[b] ? nb : b;
+                    work[num_work++] = smaller;
+                    in_work[smaller] = true;
+                }
+            }
+        }
+    }
+
+    // Renumber: dead = 0, start = 1, then breadth first
+    int *order = malloc(num_blocks * sizeof(int));
+    int *rep = malloc(num_blocks * sizeof(int));
+    int *queue = malloc(num_blocks * sizeof(int));
+    for (int b = 0; b < num_blocks; b++){
+        order[b] = -1;
+    }
+    for (int q = n - 1; q >= 0; q--){
+        rep[block[q]] = q;
+    }
+    if (block[0] == block[1]){
+        fail("a rule accepts nothing");
+    }
+    int num_ordered = 0;
+    order[block[0]] = num_ordered++;
+    order[block[1]] = num_ordered++;
+    int head = 0, tail = 0;
+    queue[tail++] = block[1];
+    while (head < tail){
+        int b = queue[head++];
+        for (int c = 0; c < nc; c++){
+            int t = block[dfa->next[rep[b] * nc + c]];
+            if (order[t] == -1){
+                order[t] = num_ordered++;
+                queue[tail++] = t;
+            }
+        }
+    }
+
+    Dfa min = { num_ordered, nc, malloc((size_t)num_ordered * nc * sizeof(int)), malloc(num_ordered * sizeof(int)) };
+    for (int b = 0; b < num_blocks; b++){
+        if (order[b] == -1){
+            continue;
+        }
+        min.tag[order[b]] = dfa->tag[rep[b]];
+        for (int c = 0; c < nc; c++){
+            min.next[order[b] * nc + c] = order[block[dfa->next[rep[b] * nc + c]]];
+        }
+    }
+
+    free(block); free(size); free(in_work); free(work); free(in_splitter);
+    free(in_x); free(count_x); free(new_block); free(order); free(rep); free(queue);
+    return min;
+}
+
+static Dfa build_minimal_dfa(const int *rule_ids, int count){
+    Dfa dfa = build_dfa(rule_ids, count);
+    Dfa min = minimize(&dfa);
+    free(dfa.next);
+    free(dfa.tag);
+    return min;
+}
+
+//RESERVED WORDS PERFECT HASH
+// Must match reserved_hash() in module_automata.h
+
+static uint32_t reserved_hash(uint32_t seed, const char *s, int len){
+    uint32_t h = seed;
+    for (int i = 0; i < len; i++){
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+// Smallest power of two table (and its seed) where every word gets its own slot
+static void find_perfect_hash(uint32_t *seed_out, uint32_t *size_out){
+    uint32_t size = 1;
+    while (size < (uint32_t)num_words){
+        size <<= 1;
+    }
+    bool used[MAX_WORDS * 8];
+    for (; size <= MAX_WORDS * 8; size <<= 1){
+        for (uint32_t seed = 1; seed <= MAX_SEED; seed++){
+            memset(used, 0, size * sizeof(bool));
+            int w = 0;
+            for (; w < num_words; w++){
+                uint32_t slot = reserved_hash(seed, words[w].text, (int)strlen(words[w].text)) & (size - 1);
+                if (used[slot]){
+                    break;
+                }
+                used[slot] = true;
+            }
+            if (w == num_words){
+                *seed_out = seed;
+                *size_out = size;
+                return;
+            }
+        }
+    }
+    fail("no perfect hash found for the reserved words");
+}
+
+static bool dfa_accepts(const Dfa *dfa, const char *text){
+    int state = 1;
+    for (const char *c = text; *c != '\0'; c++){
+        state = dfa->next[state * dfa->num_classes + class_of[(unsigned char)*c]];
+    }
+    return dfa->tag[state] != -1;
+}
+
+static void write_reserved_words(FILE *out, const Dfa *identifier){
+    uint32_t seed = 0;
+    uint32_t size = 1;
+    int max_len = 0;
+    int slot_of[MAX_WORDS];
+    for (int w = 0; w < num_words; w++){
+        if (identifier == NULL || !dfa_accepts(identifier, words[w].text)){
+            fprintf(stderr, "%s: reserved word '%s' is not an %s\n", spec_name, words[w].text, IDENTIFIER_CATEGORY);
+            exit(EXIT_FAILURE);
+        }
+        int len = (int)strlen(words[w].text);
+        max_len = len > max_len ? len : max_len;
+    }
+    if (num_words > 0){
+        find_perfect_hash(&seed, &size);
+    }
+    for (int w = 0; w < num_words; w++){
+        slot_of[w] = (int)(reserved_hash(seed, words[w].text, (int)strlen(words[w].text)) & (size - 1));
+    }
+
+    fprintf(out, "// Reserved words, looked up when the IDENTIFIER rule accepts (perfect hash: one slot per word)\n");
+    fprintf(out, "const ReservedWord RESERVED_WORDS[%u] = {\n", size);
+    for (uint32_t slot = 0; slot < size; slot++){
+        int w = 0;
+        while (w < num_words && slot_of[w] != (int)slot){
+            w++;
+        }
+        if (w < num_words){
+            fprintf(out, "    { \"%s\", %d, CAT_%s }", words[w].text, (int)strlen(words[w].text), words[w].category);
+        } else {
+            fprintf(out, "    { NULL, 0, CAT_IDENTIFIER }");
+        }
+        fprintf(out, "%s // %u\n", slot + 1 < size ? "," : "", slot);
+    }
+    fprintf(out, "};\n");
+    fprintf(out, "const uint32_t RESERVED_SEED = %uu;\n", seed);
+    fprintf(out, "const uint32_t RESERVED_MASK = %uu;\n", size - 1);
+    fprintf(out, "const int RESERVED_MAX_LEN = %d;\n", max_len);
+}
+
+//OUTPUT
+
+static void lower_name(const char *category, char *name){
+    int i = 0;
+    for (; category[i] != '\0' && i < MAX_NAME - 1; i++){
+        name[i] = (char)tolower((unsigned char)category[i]);
+    }
+    name[i] = '\0';
+}
+
+static void write_byte(FILE *out, int b){
+    if (b == '\\' || b == '\''){
+        fprintf(out, "'\\%c'", b);
+    } else if (isgraph(b)){
+        fprintf(out, "'%c'", b);
+    } else {
+        fprintf(out, "0x%02X", b);
+    }
+}
+
+// One comment line per class with its bytes (ranges compressed)
+static void write_class_legend(FILE *out){
+    for (int c = 0; c < num_classes; c++){
+        fprintf(out, "//   %2d:", c);
+        int printed = 0;
+        for (int b = 0; b < 256; b++){
+            if (class_of[b] != c || (b > 0 && class_of[b - 1] == c)){
+                continue;
+            }
+            int e = b;
+            while (e < 255 && class_of[e + 1] == c){
+                e++;
+            }
+            if (printed++ == 8){
+                fprintf(out, " ...");
+                break;
+            }
+            fprintf(out, " ");
+            write_byte(out, b);
+            if (e > b){
+                fprintf(out, "-");
+                write_byte(out, e);
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
+
+static void write_rule_automata(FILE *out, int r, const Dfa *dfa){
+    char name[MAX_NAME];
+    lower_name(rules[r].category, name);
+    if (dfa->num_states > MAX_RULE_STATES){
+        fail("rule DFA does not fit in uint8_t states");
+    }
+    fprintf(out, "// %s  (priority %d)\n", rules[r].regex, rules[r].priority);
+    fprintf(out, "static const uint8_t %s_transitions[%d][%d] = {\n", name, dfa->num_states, dfa->num_classes);
+    for (int q = 0; q < dfa->num_states; q++){
+        fprintf(out, "    {");
+        for (int c = 0; c < dfa->num_classes; c++){
+            fprintf(out, "%s%d", c ? "," : "", dfa->next[q * dfa->num_classes + c]);
+        }
+        fprintf(out, "}%s // %d%s\n", q + 1 < dfa->num_states ? "," : " ", q,
+                q == 0 ? " (dead)" : q == 1 ? " (start)" : "");
+    }
+    fprintf(out, "};\n");
+    fprintf(out, "static const uint8_t %s_accepting[%d] = {", name, (dfa->num_states + 7) / 8);
+    for (int i = 0; i < (dfa->num_states + 7) / 8; i++){
+        int bits = 0;
+        for (int q = i * 8; q < i * 8 + 8 && q < dfa->num_states; q++){
+            if (dfa->tag[q] != -1){
+                bits |= 1 << (q & 7);
+            }
+        }
+        fprintf(out, "%s0x%02X", i ? ", " : " ", bits);
+    }
+    fprintf(out, " };\n");
+    fprintf(out, "const AutomataDFA %s_automata = {\n", name);
+    fprintf(out, "    .class_of = CLASS_OF,\n");
+    fprintf(out, "    .transitions = &%s_transitions[0][0],\n", name);
+    fprintf(out, "    .accepting = %s_accepting,\n", name);
+    fprintf(out, "    .width = %d, .height = %d, .start_state = 1,\n", dfa->num_classes, dfa->num_states);
+    fprintf(out, "    .type = CAT_%s\n", rules[r].category);
+    fprintf(out, "};\n\n");
+}
+
+/**
+ * Run states of the combined DFA: states that go back to themselves with every byte
+ * except at most MAX_RUN_STOPS stop bytes ('\0' is not counted, the input ends there).
+ * E.g. the body of a literal: every byte but '"'. The scanner skips them vectorized.
+ */
+static void write_run_states(FILE *out, const Dfa *dfa){
+    int *count = malloc(dfa->num_states * sizeof(int));
+    int (*stop)[MAX_RUN_STOPS] = calloc(dfa->num_states, sizeof(*stop));
+    if (!count || !stop){
+        fprintf(stderr, "scanner_tablegen: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int q = 0; q < dfa->num_states; q++){
+        count[q] = q == 0 ? -1 : 0; // L'estat mort no és un estat de recorregut
+        for (int b = 1; b < 256 && count[q] >= 0; b++){
+            if (dfa->next[q * dfa->num_classes + class_of[b]] == q){
+                continue;
+            }
+            if (count[q] == MAX_RUN_STOPS){
+                count[q] = -1;
+            } else {
+                stop[q][count[q]++] = b;
+            }
+        }
+    }
+    fprintf(out, "// Run states: number of stop bytes (-1 = not a run state) and the stop bytes\n");
+    fprintf(out, "static const signed char combined_run_stops[%d] = {", dfa->num_states);
+    for (int q = 0; q < dfa->num_states; q++){
+        fprintf(out, "%s%d", q ? ", " : " ", count[q]);
+    }
+    fprintf(out, " };\n");
+    fprintf(out, "static const uint8_t combined_run_stop[%d][MAX_RUN_STOPS] = {\n", dfa->num_states);
+    for (int q = 0; q < dfa->num_states; q++){
+        fprintf(out, "    {");
+        for (int k = 0; k < MAX_RUN_STOPS; k++){
+            fprintf(out, "%s%d", k ? "," : "", count[q] > k ? stop[q][k] : 0);
+        }
+        fprintf(out, "}%s // %d\n", q + 1 < dfa->num_states ? "," : " ", q);
+    }
+    fprintf(out, "};\n");
+    free(count);
+    free(stop);
+}
+
+/**
+ * Pending category of every state of the combined DFA: the highest priority rule that can
+ * still accept from it (the token it was scanning), -1 if none. The scanner uses it to name
+ * the error of a runaway token (e.g. a '"' never closed is an unterminated LITERAL).
+ */
+static void write_pending(FILE *out, const Dfa *dfa){
+    int *pending = malloc(dfa->num_states * sizeof(int));
+    bool *seen = malloc(dfa->num_states * sizeof(bool));
+    int *queue = malloc(dfa->num_states * sizeof(int));
+    if (!pending || !seen || !queue){
+        fprintf(stderr, "scanner_tablegen: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int q = 0; q < dfa->num_states; q++){ // Recorregut en amplada des de q
+        pending[q] = -1;
+        memset(seen, 0, dfa->num_states * sizeof(bool));
+        int head = 0, tail = 0;
+        if (q != 0){
+            queue[tail++] = q;
+            seen[q] = true;
+        }
+        while (head < tail){
+            int r = queue[head++];
+            if (dfa->tag[r] != -1 && (pending[q] == -1 || dfa->tag[r] < pending[q])){
+                pending[q] = dfa->tag[r]; // Les regles estan ordenades per prioritat
+            }
+            for (int c = 0; c < dfa->num_classes; c++){
+                int next = dfa->next[r * dfa->num_classes + c];
+                if (next != 0 && !seen[next]){
+                    seen[next] = true;
+                    queue[tail++] = next;
+                }
+            }
+        }
+    }
+    fprintf(out, "// Pending category: highest priority rule that can still accept from the state, or -1\n");
+    fprintf(out, "static const signed char combined_pending[%d] = {\n", dfa->num_states);
+    for (int q = 0; q < dfa->num_states; q++){
+        if (pending[q] == -1){
+            fprintf(out, "    -1");
+        } else {
+            fprintf(out, "    CAT_%s", rules[pending[q]].category);
+        }
+        fprintf(out, "%s // %d\n", q + 1 < dfa->num_states ? "," : "", q);
+    }
+    fprintf(out, "};\n");
+    free(pending);
+    free(seen);
+    free(queue);
+}
+
+/**
+ * First byte dispatch of the lockstep engine: bit r of first_byte[b] is set if rule r has a
+ * transition from its start state with byte b. The rest die with the first character.
+ */
+static void write_first_byte(FILE *out, const uint64_t *first_byte){
+    fprintf(out, "// First byte -> rules that can start a token with it (bit i = ALL_AUTOMATA[i])\n");
+    fprintf(out, "const uint64_t FIRST_BYTE_AUTOMATA[256] = {\n");
+    for (int b = 0; b < 256; b++){
+        fprintf(out, "%s0x%llXull%s", b % 8 == 0 ? "    " : "", (unsigned long long)first_byte[b],
+                b == 255 ? "\n" : b % 8 == 7 ? ",\n" : ", ");
+    }
+    fprintf(out, "};\n\n");
+}
+
+/**
+ * Rule automata for the vector engine: cell [class][state][lane] is the next state of rule
+ * lane (| VECTOR_ACCEPT if it accepts), every lane with the rows of the tallest automaton.
+ * The lanes are rounded up to VECTOR_LANES; the padding lanes start (and stay) dead.
+ */
+static void write_vector_automata(FILE *out, const Dfa *dfas, int count){
+    int num_lanes = (count + VECTOR_LANES - 1) / VECTOR_LANES * VECTOR_LANES;
+    int num_states = 0;
+    for (int r = 0; r < count; r++){
+        if (dfas[r].num_states > num_states){
+            num_states = dfas[r].num_states;
+        }
+    }
+    int num_classes = dfas[0].num_classes;
+    fprintf(out, "// Rule automata interleaved: [class][state][lane] -> next state | VECTOR_ACCEPT\n");
+    fprintf(out, "static const int32_t vector_next[%d] = {\n", num_classes * num_states * num_lanes);
+    for (int c = 0; c < num_classes; c++){
+        for (int q = 0; q < num_states; q++){
+            fprintf(out, "    ");
+            for (int lane = 0; lane < num_lanes; lane++){
+                int cell = 0;
+                if (lane < count && q < dfas[lane].num_states){
+                    const Dfa *dfa = &dfas[lane];
+                    int next = dfa->next[q * dfa->num_classes + c];
+                    cell = next | (next != 0 && dfa->tag[next] != -1 ? VECTOR_ACCEPT : 0);
+                }
+                fprintf(out, "%d,", cell);
+            }
+            fprintf(out, " // class %d, state %d\n", c, q);
+        }
+    }
+    fprintf(out, "};\n");
+    fprintf(out, "static const int32_t vector_start[%d] = {", num_lanes);
+    for (int lane = 0; lane < num_lanes; lane++){
+        fprintf(out, "%s%d", lane ? ", " : " ", lane < count ? 1 : 0);
+    }
+    fprintf(out, " };\n");
+    fprintf(out, "static const signed char vector_type[%d] = {", num_lanes);
+    for (int lane = 0; lane < num_lanes; lane++){
+        if (lane < count){
+            fprintf(out, "%sCAT_%s", lane ? ", " : " ", rules[lane].category);
+        } else {
+            fprintf(out, ", -1");
+        }
+    }
+    fprintf(out, " };\n");
+    fprintf(out, "const VectorAutomata VECTOR_AUTOMATA = {\n");
+    fprintf(out, "    .class_of = CLASS_OF,\n");
+    fprintf(out, "    .num_lanes = %d, .num_states = %d,\n", num_lanes, num_states);
+    fprintf(out, "    .next = vector_next,\n");
+    fprintf(out, "    .start = vector_start,\n");
+    fprintf(out, "    .type = vector_type\n");
+    fprintf(out, "};\n\n");
+}
+
+static void write_combined(FILE *out, const Dfa *dfa){
+    fprintf(out, "// All the rules together; accept = category of the highest priority accepting rule\n");
+    fprintf(out, "static const short combined_next[%d][%d] = {\n", dfa->num_states, dfa->num_classes);
+    for (int q = 0; q < dfa->num_states; q++){
+        fprintf(out, "    {");
+        for (int c = 0; c < dfa->num_classes; c++){
+            fprintf(out, "%s%d", c ? "," : "", dfa->next[q * dfa->num_classes + c]);
+        }
+        fprintf(out, "}%s // %d\n", q + 1 < dfa->num_states ? "," : " ", q);
+    }
+    fprintf(out, "};\n");
+    fprintf(out, "static const signed char combined_accept[%d] = {\n", dfa->num_states);
+    for (int q = 0; q < dfa->num_states; q++){
+        if (dfa->tag[q] == -1){
+            fprintf(out, "    -1");
+        } else {
+            fprintf(out, "    CAT_%s", rules[dfa->tag[q]].category);
+        }
+        fprintf(out, "%s // %d\n", q + 1 < dfa->num_states ? "," : "", q);
+    }
+    fprintf(out, "};\n");
+    write_run_states(out, dfa);
+    write_pending(out, dfa);
+    fprintf(out, "const CombinedDFA COMBINED_AUTOMATA = {\n");
+    fprintf(out, "    .class_of = CLASS_OF,\n");
+    fprintf(out, "    .num_classes = %d, .num_states = %d, .start_state = 1,\n", dfa->num_classes, dfa->num_states);
+    fprintf(out, "    .next_state = &combined_next[0][0],\n");
+    fprintf(out, "    .accept = combined_accept,\n");
+    fprintf(out, "    .run_stops = combined_run_stops,\n");
+    fprintf(out, "    .run_stop = combined_run_stop,\n");
+    fprintf(out, "    .pending = combined_pending\n");
+    fprintf(out, "};\n");
+}
+
+int main(int argc, char *argv[]){
+    if (argc != 3){
+        fprintf(stderr, "Usage: %s <tokens.spec> <output.c>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    spec_name = argv[1];
+    read_spec(argv[1]);
+    compute_classes();
+
+    FILE *out = fopen(argv[2], "w");
+    if (!out){
+        fprintf(stderr, "scanner_tablegen: cannot write %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    fprintf(out, "/*\n * Generated by scanner_tablegen from tokens.spec. DO NOT EDIT.\n */\n\n");
+    fprintf(out, "#include \"module_automata.h\"\n\n");
+    fprintf(out, "// Byte classes:\n");
+    write_class_legend(out);
+    fprintf(out, "static const uint8_t CLASS_OF[256] = {\n");
+    for (int b = 0; b < 256; b++){
+        fprintf(out, "%s%2d%s", b % 16 == 0 ? "    " : "", class_of[b], b == 255 ? "\n" : b % 16 == 15 ? ",\n" : ",");
+    }
+    fprintf(out, "};\n\n");
+
+    int all[MAX_RULES];
+    Dfa rule_dfa[MAX_RULES];
+    uint64_t first_byte[256] = { 0 };
+    const Dfa *identifier = NULL;
+    for (int r = 0; r < num_rules; r++){
+        all[r] = r;
+        spec_line = 0;
+        rule_dfa[r] = build_minimal_dfa(&all[r], 1);
+        const Dfa *dfa = &rule_dfa[r];
+        write_rule_automata(out, r, dfa);
+        for (int b = 0; b < 256; b++){
+            if (dfa->next[1 * dfa->num_classes + class_of[b]] != 0){ // Transició des de l'inici (estat 1)
+                first_byte[b] |= (uint64_t)1 << r;
+            }
+        }
+        if (strcmp(rules[r].category, IDENTIFIER_CATEGORY) == 0){
+            identifier = dfa;
+        }
+    }
+
+    fprintf(out, "const AutomataDFA* const ALL_AUTOMATA[] = {\n");
+    for (int r = 0; r < num_rules; r++){
+        char name[MAX_NAME];
+        lower_name(rules[r].category, name);
+        fprintf(out, "    &%s_automata%s\n", name, r + 1 < num_rules ? "," : "");
+    }
+    fprintf(out, "};\n\nconst int NUM_AUTOMATA = sizeof(ALL_AUTOMATA) / sizeof(ALL_AUTOMATA[0]);\n\n");
+    write_first_byte(out, first_byte);
+    write_vector_automata(out, rule_dfa, num_rules);
+
+    Dfa combined = build_minimal_dfa(all, num_rules);
+    write_combined(out, &combined);
+    free(combined.next);
+    free(combined.tag);
+
+    fprintf(out, "\n");
+    write_reserved_words(out, identifier);
+    for (int r = 0; r < num_rules; r++){
+        free(rule_dfa[r].next);
+        free(rule_dfa[r].tag);
+    }
+
+    if (fclose(out) != 0){
+        fprintf(stderr, "scanner_tablegen: error writing %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+/*
+ * -----------------------------------------------------------------------------
+ * check_counts.c
+ *
+ * Compares the operation counts of a scanner run with the committed baseline.
+ * Both files are the TSV written by `scanner -counttsv FILE`:
+ *     <input>\t<function>\t<comp>\t<io>\t<gen>      (# lines are comments)
+ *
+ * The counts (COMP + IO + GEN) do not depend on the machine, so the test fails
+ * when the TOTAL work of an input grows more than the allowed percentage. The
+ * functions that grew are listed to find the change. Inputs that need less
+ * work only print a note (update the baseline to keep the new numbers).
+ *
+ * Usage: check_counts <baseline.tsv> <run.tsv> [max_growth_percent (default 2)]
+ * Returns 0 if no input grew, 1 if one did, 77 (skipped) if the run has no
+ * counts (the scanner only counts in the DEBUG outformat).
+ *
+ * Team: GA
+ * Contributor/s: Marc Rodríguez
+ * -----------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ROWS 4096
+#define MAX_NAME 256
+#define SKIP_RETURN 77
+#define DEFAULT_MAX_GROWTH 2.0
+
+typedef struct CountRow {
+    char input[MAX_NAME];
+    char function[MAX_NAME];
+    long long comp;
+    long long io;
+    long long gen;
+} CountRow;
+
+typedef struct CountTable {
+    CountRow rows[MAX_ROWS];
+    int count;
+} CountTable;
+
+static long long row_total(const CountRow *row) {
+    return row->comp + row->io + row->gen;
+}
+
+static int read_table(const char *filename, CountTable *table) {
+    FILE *f = fopen(filename, "r");
+    if (!f) {
+        fprintf(stderr, "check_counts: cannot open %s\n", filename);
+        return -1;
+    }
+    char line[1024];
+    table->count = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        CountRow *row = &table->rows[table->count];
+        if (sscanf(line, "%255[^\t]\t%255[^\t]\t%lld\t%lld\t%lld",
+                   row->input, row->function, &row->comp, &row->io, &row->gen) != 5) {
+            fprintf(stderr, "check_counts: bad line in %s: %s", filename, line);
+            continue;
+        }
+        if (table->count < MAX_ROWS - 1) {
+            table->count++;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+static const CountRow *find_row(const CountTable *table, const char *input, const char *function) {
+    for (int i = 0; i < table->count; i++) {
+        if (strcmp(table->rows[i].input, input) == 0 && strcmp(table->rows[i].function, function) == 0) {
+            return &table->rows[i];
+        }
+    }
+    return NULL;
+}
+
+// Functions of input whose work grew (or that are new) compared with the baseline
+static void print_function_growth(const CountTable *baseline, const CountTable *run, const char *input) {
+    for (int i = 0; i < run->count; i++) {
+        const CountRow *now = &run->rows[i];
+        if (strcmp(now->input, input) != 0 || strcmp(now->function, "TOTAL") == 0) {
+            continue;
+        }
+        const CountRow *before = find_row(baseline, input, now->function);
+        long long before_total = before ? row_total(before) : 0;
+        if (row_total(now) > before_total) {
+            printf("    %-30s %lld -> %lld (comp %lld, io %lld, gen %lld)\n", now->function,
+                   before_total, row_total(now), now->comp, now->io, now->gen);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <baseline.tsv> <run.tsv> [max_growth_percent]\n", argv[0]);
+        return 1;
+    }
+    double max_growth = argc > 3 ? atof(argv[3]) : DEFAULT_MAX_GROWTH;
+
+    static CountTable baseline, run;
+    if (read_table(argv[1], &baseline) != 0 || read_table(argv[2], &run) != 0) {
+        return 1;
+    }
+    if (run.count == 0) {
+        printf("No counts in %s: the scanner only counts in the DEBUG outformat (skipped)\n", argv[2]);
+        return SKIP_RETURN;
+    }
+
+    int failed = 0;
+    for (int i = 0; i < baseline.count; i++) {
+        const CountRow *before = &baseline.rows[i];
+        if (strcmp(before->function, "TOTAL") != 0) {
+            continue;
+        }
+        const CountRow *now = find_row(&run, before->input, "TOTAL");
+        if (!now) {
+            printf("FAIL %s: not in the run\n", before->input);
+            failed = 1;
+            continue;
+        }
+        long long old_total = row_total(before);
+        long long new_total = row_total(now);
+        double growth = old_total ? 100.0 * (double)(new_total - old_total) / (double)old_total : 0.0;
+        if (growth > max_growth) {
+            printf("FAIL %s: %lld -> %lld operations (+%.2f%%, max +%.2f%%)\n",
+                   before->input, old_total, new_total, growth, max_growth);
+            print_function_growth(&baseline, &run, before->input);
+            failed = 1;
+        } else if (growth < -max_growth) {
+            printf("note %s: %lld -> %lld operations (%.2f%%), update the baseline\n",
+                   before->input, old_total, new_total, growth);
+        } else {
+            printf("ok   %s: %lld -> %lld operations (%+.2f%%)\n", before->input, old_total, new_total, growth);
+        }
+    }
+    for (int i = 0; i < run.count; i++) {
+        if (strcmp(run.rows[i].function, "TOTAL") == 0 && !find_row(&baseline, run.rows[i].input, "TOTAL")) {
+            printf("note %s: not in the baseline, update it\n", run.rows[i].input);
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,9 @@
+char *s = "one line";
+char *m = "two
+lines";
+char *e = "";
+int x = 10 + 20 * 30;
+$$ @@ ### 1abc abc1 _under_score
+while (x > 0) { x = x + -1; }
+if (x) return 0; else return 1;
+char *u = "unterminated
@@ -0,0 +1,50 @@
+# -----------------------------------------------------------------------------
+# tests/count_baseline/run_counts.cmake
+#
+# Runs the scanner on every file of the corpus with -counttsv and compares the
+# counts with the committed baseline (check_counts). With -DUPDATE=ON the run
+# replaces the baseline instead (target update_count_baseline).
+#
+# Variables: SCANNER, CHECK, CORPUS, BASELINE, WORK, UPDATE (optional)
+# -----------------------------------------------------------------------------
+
+file(REMOVE_RECURSE "${WORK}")
+file(MAKE_DIRECTORY "${WORK}")
+file(GLOB inputs RELATIVE "${CORPUS}" "${CORPUS}/*.c")
+list(SORT inputs)
+
+# The scanner writes its outputs next to the input: it works on a copy
+file(COPY ${CORPUS}/ DESTINATION "${WORK}")
+file(WRITE "${WORK}/run.tsv" "# input\tfunction\tcomp\tio\tgen\n")
+
+foreach(input IN LISTS inputs)
+    execute_process(
+        COMMAND "${SCANNER}" "${input}" -counttsv run.tsv
+        WORKING_DIRECTORY "${WORK}"
+        RESULT_VARIABLE result
+        OUTPUT_QUIET
+        ERROR_QUIET
+    )
+    # The exit code is the number of scanner errors (the corpus has some on purpose): only a crash fails
+    if(NOT result MATCHES "^[0-9]+$")
+        message(FATAL_ERROR "scanner failed on ${input} (${result})")
+    endif()
+endforeach()
+
+if(UPDATE)
+    file(READ "${WORK}/run.tsv" counts)
+    file(WRITE "${BASELINE}" "${counts}")
+    message(STATUS "Count baseline updated: ${BASELINE}")
+    return()
+endif()
+
+execute_process(
+    COMMAND "${CHECK}" "${BASELINE}" "${WORK}/run.tsv"
+    RESULT_VARIABLE result
+)
+if(result EQUAL 77)
+    message(STATUS "SKIPPED: no operation counts in this build")
+    # cmake -P only returns 0 or 1: the skip is recognised by SKIP_REGULAR_EXPRESSION
+elseif(NOT result EQUAL 0)
+    message(FATAL_ERROR "Operation counts grew past the baseline (see above)")
+endif()
@@ -0,0 +1,334 @@
+/*
+ * -----------------------------------------------------------------------------
+ * test_scanner_api.c
+ *
+ * Test of the pull API of the scanner (module_api): the tokens of a buffer
+ * with their category, line, column and symbol ID, the same with every engine,
+ * and two scanners open at the same time that do not share state. A '\0'
+ * inside the buffer is one token and the scan goes on after it, and every
+ * non-ASCII character outside a literal is a token of its own. A number is
+ * the longest prefix that is one ("2.x" is 2 . x, "1.2.3" is 1.2 . 3). The
+ * incremental scan (TokenStream) gets random edits and after every one its
+ * tokens have to be the ones of a full scan of the edited text.
+ *
+ * Returns 0 if every check passes, 1 otherwise (the failed ones are printed).
+ *
+ * Team: GA
+ * Contributor/s: Jan Prats
+ * -----------------------------------------------------------------------------
+ */
+
+#include "module_api.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TEST_TOKENS 64
+
+typedef struct ExpectedToken {
+    const char *lexeme;
+    Category cat;
+    int line;
+    int column;
+    int symbol;     // IDs in order of first occurrence
+} ExpectedToken;
+
+static const char SOURCE[] =
+    "int main() {\n"
+    "    x += x + 25;\n"
+    "    s = \"h\xc3\xa9llo\"; \xc3\xa9 $\n"     // "héllo" i é: columnes en caràcters
+    "}\n";
+
+static const ExpectedToken EXPECTED[] = {
+    {"int", CAT_TYPE, 1, 1, 0},                  {"main", CAT_IDENTIFIER, 1, 5, 1},
+    {"(", CAT_SPECIALCHAR, 1, 9, NO_SYMBOL},     {")", CAT_SPECIALCHAR, 1, 10, NO_SYMBOL},
+    {"{", CAT_SPECIALCHAR, 1, 12, NO_SYMBOL},
+    {"x", CAT_IDENTIFIER, 2, 5, 2},              {"+=", CAT_OPERATOR, 2, 7, NO_SYMBOL},
+    {"x", CAT_IDENTIFIER, 2, 10, 2},             {"+", CAT_OPERATOR, 2, 12, NO_SYMBOL},
+    {"25", CAT_NUMBER, 2, 14, NO_SYMBOL},        {";", CAT_SPECIALCHAR, 2, 16, NO_SYMBOL},
+    {"s", CAT_IDENTIFIER, 3, 5, 3},              {"=", CAT_OPERATOR, 3, 7, NO_SYMBOL},
+    {"\"h\xc3\xa9llo\"", CAT_LITERAL, 3, 9, 4},
+    {";", CAT_SPECIALCHAR, 3, 16, NO_SYMBOL},    {"\xc3\xa9", CAT_NONRECOGNIZED, 3, 18, NO_SYMBOL},
+    {"$", CAT_NONRECOGNIZED, 3, 20, NO_SYMBOL},
+    {"}", CAT_SPECIALCHAR, 4, 1, NO_SYMBOL},
+};
+#define NUM_EXPECTED ((int)(sizeof(EXPECTED) / sizeof(EXPECTED[0])))
+
+static int failures = 0;
+
+static void check(bool ok, const char *what, Engine engine, int k) {
+    if (!ok) {
+        fprintf(stderr, "test_scanner_api: engine %d, token %d: %s\n", (int)engine, k, what);
+        failures++;
+    }
+}
+
+static void check_tokens(Engine engine) {
+    Scanner *scanner = scanner_open(SOURCE, (int)strlen(SOURCE), engine);
+    if (!scanner) {
+        check(false, "scanner_open failed", engine, 0);
+        return;
+    }
+    ScannerToken tok;
+    int k = 0;
+    while (scanner_next(scanner, &tok)) {
+        if (k >= NUM_EXPECTED) {
+            check(false, "more tokens than expected", engine, k);
+            break;
+        }
+        const ExpectedToken *e = &EXPECTED[k];
+        check(tok.len == (int)strlen(e->lexeme) && memcmp(tok.lexeme, e->lexeme, tok.len) == 0, "lexeme", engine, k);
+        check(memcmp(SOURCE + tok.offset, e->lexeme, strlen(e->lexeme)) == 0, "offset", engine, k);
+        check(tok.cat == e->cat, "category", engine, k);
+        check(tok.line == e->line, "line", engine, k);
+        check(tok.column == e->column, "column", engine, k);
+        check(tok.error == ERR_NONE, "error", engine, k);
+        check(tok.symbol == e->symbol, "symbol", engine, k);
+        k++;
+    }
+    check(k == NUM_EXPECTED, "fewer tokens than expected", engine, k);
+    check(!scanner_next(scanner, &tok), "token after the end", engine, k);
+    check(scanner_num_symbols(scanner) == 5, "number of symbols", engine, k);
+    scanner_close(scanner);
+}
+
+// Two scans interleaved: every scanner keeps its own position, lines and cursors
+static void check_independent(void) {
+    const char *a = "int a;\nint b;\n";
+    const char *b = "\"open\nx\n";
+    Scanner *first = scanner_open(a, (int)strlen(a), ENGINE_LOCKSTEP);
+    Scanner *second = scanner_open(b, (int)strlen(b), ENGINE_LOCKSTEP);
+    ScannerToken ta, tb;
+    int count_a = 0;
+    bool more_a = scanner_next(first, &ta);
+    bool more_b = scanner_next(second, &tb);
+    check(more_b && tb.cat == CAT_NONRECOGNIZED && tb.error == ERR_UNTERMINATED_LITERAL,
+          "unterminated literal", ENGINE_LOCKSTEP, 0);
+    more_b = scanner_next(second, &tb);
+    check(more_b && tb.len == 1 && tb.lexeme[0] == 'x' && tb.line == 2, "token after the literal", ENGINE_LOCKSTEP, 1);
+    while (more_a) {
+        count_a++;
+        more_a = scanner_next(first, &ta);
+    }
+    check(count_a == 6, "tokens of the first scanner", ENGINE_LOCKSTEP, count_a);
+    scanner_close(first);
+    scanner_close(second);
+}
+
+// A '\0' inside the input is a token of its own (with an error) and the scan goes on up to len
+static void check_nul(Engine engine) {
+    static const char text[] = "int b\0 = 3;";
+    static const char *lexemes[] = {"int", "b", "\0", "=", "3", ";"};
+    Scanner *scanner = scanner_open(text, (int)sizeof(text) - 1, engine);
+    ScannerToken tok;
+    int k = 0;
+    while (scanner_next(scanner, &tok)) {
+        if (k == 6) {
+            check(false, "more tokens than expected (NUL)", engine, k);
+            break;
+        }
+        check(tok.len == 1 + (k == 0) * 2 && memcmp(tok.lexeme, lexemes[k], tok.len) == 0, "lexeme (NUL)", engine, k);
+        check((k == 2) == (tok.cat == CAT_NONRECOGNIZED && tok.error == ERR_NUL_BYTE), "NUL token", engine, k);
+        k++;
+    }
+    check(k == 6, "tokens after the NUL", engine, k);
+    scanner_close(scanner);
+}
+
+// Longest match: a token that stops in a non-accepting state goes back to its last accepted prefix
+static void check_numbers(Engine engine) {
+    static const char text[] = "2.0 3.x 1.2.3 4..";
+    static const char *lexemes[] = {"2.0", "3", ".", "x", "1.2", ".", "3", "4", ".", "."};
+    static const Category cats[] = {CAT_NUMBER, CAT_NUMBER, CAT_OPERATOR, CAT_IDENTIFIER, CAT_NUMBER,
+                                    CAT_OPERATOR, CAT_NUMBER, CAT_NUMBER, CAT_OPERATOR, CAT_OPERATOR};
+    Scanner *scanner = scanner_open(text, (int)sizeof(text) - 1, engine);
+    ScannerToken tok;
+    int k = 0;
+    while (scanner_next(scanner, &tok)) {
+        if (k == 10) {
+            check(false, "more tokens than expected (numbers)", engine, k);
+            break;
+        }
+        check(tok.len == (int)strlen(lexemes[k]) && memcmp(tok.lexeme, lexemes[k], tok.len) == 0, "lexeme (numbers)", engine, k);
+        check(tok.cat == cats[k] && tok.error == ERR_NONE, "category (numbers)", engine, k);
+        k++;
+    }
+    check(k == 10, "tokens of the numbers", engine, k);
+    scanner_close(scanner);
+}
+
+// A character that no rule starts is one token (a whole UTF-8 sequence, or one invalid byte)
+static void check_code_points(Engine engine) {
+    static const char text[] = "\xe6\xb1\x89\xe5\xad\x97 @\xc3\xa9 \xe4x";  // 汉字 @é, and a cut sequence
+    static const char *lexemes[] = {"\xe6\xb1\x89", "\xe5\xad\x97", "@", "\xc3\xa9", "\xe4", "x"};
+    static const int columns[] = {1, 2, 4, 5, 7, 8};
+    Scanner *scanner = scanner_open(text, (int)sizeof(text) - 1, engine);
+    ScannerToken tok;
+    int k = 0;
+    while (scanner_next(scanner, &tok)) {
+        if (k == 6) {
+            check(false, "more tokens than expected (UTF-8)", engine, k);
+            break;
+        }
+        check(tok.len == (int)strlen(lexemes[k]) && memcmp(tok.lexeme, lexemes[k], tok.len) == 0, "lexeme (UTF-8)", engine, k);
+        check(tok.column == columns[k], "column (UTF-8)", engine, k);
+        check((k == 5) == (tok.cat == CAT_IDENTIFIER), "category (UTF-8)", engine, k);
+        k++;
+    }
+    check(k == 6, "one token per character", engine, k);
+    scanner_close(scanner);
+}
+
+// Una línia llarga no ASCII: les columnes es compten des del token d'abans, no des de l'inici de la línia
+#define LONG_LINE_TOKENS 50000
+static void check_long_line(Engine engine) {
+    int len = 3 + 2 * LONG_LINE_TOKENS;
+    char *text = malloc((size_t)len + 1);
+    memcpy(text, "\xc3\xa9 ", 3);
+    for (int k = 0; k < LONG_LINE_TOKENS; k++) {
+        memcpy(text + 3 + 2 * k, "a ", 2);
+    }
+    text[len] = '\0';
+
+    Scanner *scanner = scanner_open(text, len, engine);
+    ScannerToken tok;
+    int k = 0;
+    while (scanner_next(scanner, &tok)) {
+        check(tok.line == 1 && tok.column == 2 * k + 1, "column (long line)", engine, k);
+        k++;
+    }
+    check(k == LONG_LINE_TOKENS + 1, "tokens (long line)", engine, k);
+    scanner_close(scanner);
+
+    TokenStream *stream = token_stream_open(text, len, engine);
+    for (k = 0; k <= LONG_LINE_TOKENS; k++) {
+        check(token_stream_get(stream, k, &tok) && tok.column == 2 * k + 1, "stream column (long line)", engine, k);
+    }
+    for (k = LONG_LINE_TOKENS; k > LONG_LINE_TOKENS - 10; k--) {    // Enrere: torna a l'inici de la línia
+        check(token_stream_get(stream, k, &tok) && tok.column == 2 * k + 1, "stream column backwards", engine, k);
+    }
+    check(token_stream_get(stream, 3, &tok) && tok.column == 7, "stream column before an edit", engine, 3);
+    ScanEdit edit = {0, 2, "\xe6\xb1\x89", 3};     // Tres bytes, un caràcter: les columnes no es mouen
+    check(token_stream_edit(stream, &edit, 1) >= 0 && token_stream_get(stream, 7, &tok) && tok.column == 15,
+          "stream column after an edit", engine, 7);
+    token_stream_close(stream);
+    free(text);
+}
+
+// Tokens of the stream == tokens of a full scan of its text
+static bool same_as_full_scan(TokenStream *stream, Engine engine) {
+    int len;
+    const char *text = token_stream_text(stream, &len);
+    Scanner *scanner = scanner_open(text, len, engine);
+    ScannerToken full, incremental;
+    int k = 0;
+    bool same = true;
+    while (same && scanner_next(scanner, &full)) {
+        same = token_stream_get(stream, k, &incremental)
+            && full.offset == incremental.offset && full.len == incremental.len
+            && full.cat == incremental.cat && full.error == incremental.error
+            && full.line == incremental.line && full.column == incremental.column;
+        k++;
+    }
+    same = same && k == token_stream_count(stream);
+    scanner_close(scanner);
+    return same;
+}
+
+// Pieces of text that start, end or join tokens (literals cut by a newline, UTF-8, runaways)
+static const char *PIECES[] = {
+    "x", "12", " ", "\n", "\"", "\"ab\ncd\"", "+", "=", "+=", "(", ";", "int", "if", "\xc3\xa9", "$#", "\t", "y2",
+    "\xe6\xb1\x89", "\xe4\xb8", "\xb8", ".", "2.", "0.5",
+};
+#define NUM_PIECES ((int)(sizeof(PIECES) / sizeof(PIECES[0])))
+
+static unsigned random_next(unsigned *seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return (*seed >> 16) & 0x7FFF;
+}
+
+static int len_of(const TokenStream *stream) {
+    int len;
+    token_stream_text(stream, &len);
+    return len;
+}
+
+static void check_incremental(Engine engine) {
+    TokenStream *stream = token_stream_open(SOURCE, (int)strlen(SOURCE), engine);
+    if (!stream) {
+        check(false, "token_stream_open failed", engine, 0);
+        return;
+    }
+    check(same_as_full_scan(stream, engine), "stream after open", engine, 0);
+    unsigned seed = 2024;
+    for (int step = 0; step < 2000; step++) {
+        int len;
+        token_stream_text(stream, &len);
+        ScanEdit edit;
+        edit.offset = (int)(random_next(&seed) % (unsigned)(len + 1));
+        edit.removed = (int)(random_next(&seed) % 4);
+        if (edit.removed > len - edit.offset) {
+            edit.removed = len - edit.offset;
+        }
+        edit.text = PIECES[random_next(&seed) % NUM_PIECES];
+        edit.inserted = random_next(&seed) % 3 == 0 ? 0 : (int)strlen(edit.text);
+        if (len > 300) {    // Que no creixi sense límit
+            edit.inserted = 0;
+            edit.removed = 3;
+        }
+        if (token_stream_edit(stream, &edit, 1) < 0) {
+            check(false, "token_stream_edit failed", engine, step);
+            break;
+        }
+        if (!same_as_full_scan(stream, engine)) {
+            check(false, "stream after an edit", engine, step);
+            break;
+        }
+    }
+    ScanEdit nul = {len_of(stream) / 2, 0, "a\0b", 3};
+    check(token_stream_edit(stream, &nul, 1) >= 0 && same_as_full_scan(stream, engine), "stream after a NUL", engine, 0);
+    ScanEdit outside = {1000000, 0, "x", 1};
+    check(token_stream_edit(stream, &outside, 1) == -1, "edit out of the text", engine, 0);
+    token_stream_close(stream);
+
+    // Una tecla al mig d'un text llarg: només es torna a escanejar el token on cau
+    char text[200 * 12 + 1];
+    for (int line = 0; line < 200; line++) {
+        memcpy(text + line * 12, "xy = z + 1;\n", 12);
+    }
+    text[200 * 12] = '\0';
+    stream = token_stream_open(text, 200 * 12, engine);
+    ScanEdit keys[2] = {{100 * 12 + 1, 0, "w", 1}, {150 * 12 + 9, 1, "22", 2}};
+    int scanned = token_stream_edit(stream, keys, 2);
+    check(scanned > 0 && scanned <= 4, "tokens scanned again for two keys", engine, scanned);
+    check(token_stream_count(stream) == 200 * 6 && same_as_full_scan(stream, engine), "stream after two keys", engine, 0);
+    token_stream_close(stream);
+}
+
+int main(void) {
+    check_tokens(ENGINE_COMBINED);
+    check_tokens(ENGINE_LOCKSTEP);
+    check_tokens(ENGINE_VECTOR);
+    check_independent();
+    check_nul(ENGINE_COMBINED);
+    check_nul(ENGINE_LOCKSTEP);
+    check_nul(ENGINE_VECTOR);
+    check_numbers(ENGINE_COMBINED);
+    check_numbers(ENGINE_LOCKSTEP);
+    check_numbers(ENGINE_VECTOR);
+    check_code_points(ENGINE_COMBINED);
+    check_code_points(ENGINE_LOCKSTEP);
+    check_code_points(ENGINE_VECTOR);
+    check_long_line(ENGINE_COMBINED);
+    check_long_line(ENGINE_LOCKSTEP);
+    check_long_line(ENGINE_VECTOR);
+    check_incremental(ENGINE_COMBINED);
+    check_incremental(ENGINE_LOCKSTEP);
+    check_incremental(ENGINE_VECTOR);
+    if (failures > 0) {
+        fprintf(stderr, "test_scanner_api: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("test_scanner_api: all checks passed\n");
+    return 0;
+}